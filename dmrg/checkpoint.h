@@ -0,0 +1,106 @@
+#ifndef _PROTOTYPE_CHECKPOINT_H
+#define _PROTOTYPE_CHECKPOINT_H 1
+
+#include <vector>
+#include <string>
+#include <future>
+#include <set>
+#include <chrono>
+
+#include "mpsite.h"
+
+namespace prototype {
+
+/// Position in DMRG sweeps, which points the next step to be done
+struct DmrgPosition {
+  int    iter;    ///< sweep iteration
+  bool   forward; ///< true if in forward half-sweep
+  int    site;    ///< site index of the next step in the half-sweep
+  double esav;    ///< energy of the last sweep
+  double emin;    ///< lowest energy in the current sweep so far
+
+  DmrgPosition() : iter(0), forward(true), site(0), esav(1.0e8), emin(1.0e8) { }
+};
+
+/// Checkpoint of DMRG sweeps
+/// MPS and renormalized operators of each site are stored in files, together with a manifest
+/// which holds the sweep position and the generation of file for each site.
+/// After each step, only the changed sites are written with new generation:
+///   1) changed arrays are copied, and the sweep continues
+///   2) copies are written in background and synced to disk, then the manifest is replaced by rename, which is atomic,
+///      and the directory is synced
+///   3) files of the older generation are removed
+/// Thus the manifest always refers to a complete set of files, and restart resumes from the last complete step.
+/// At most one snapshot is in flight, a new one waits for the previous.
+/// If interval is set, snapshots are taken at most once per interval, and changed sites are accumulated in between.
+/// MPO is not stored, it must be constructed before restore.
+class DmrgCheckpoint {
+public:
+  /// \param prefix path prefix of files, e.g. "/scratch/ckpt", manifest is named as prefix.manifest
+  ///        If built with MPI, rank is appended as prefix.rankN, since every rank writes its own checkpoint
+  /// \param interval min. interval of snapshots in seconds
+  DmrgCheckpoint(const std::string& prefix = "dmrg", double interval = 0.0);
+
+  /// Wait for pending snapshot
+ ~DmrgCheckpoint();
+
+  /// Write all sites synchronously
+  void save_all(const MpStorages& sites, const DmrgPosition& pos);
+
+  /// Snapshot changed sites and the position, written in background
+  /// If force is false, snapshot is skipped within interval from the last one
+  void save(const MpStorages& sites, const std::vector<int>& changed, const DmrgPosition& pos, bool force = false);
+
+  /// Read the last complete checkpoint, returns false if not found
+  /// Site files of other generations than the manifest refers to, e.g. of a snapshot interrupted before publishing, are removed
+  bool restore(MpStorages& sites, DmrgPosition& pos);
+
+  /// Remove the manifest and all site files, s.t. the next dmrg() starts from the current sites
+  void discard();
+
+  /// Wait for pending snapshot, exceptions thrown in background are re-thrown here
+  void wait();
+
+  /// Snapshot sites changed since the last one regardless of interval, and wait for it
+  void finish(const MpStorages& sites, const DmrgPosition& pos);
+
+private:
+  /// File name for k-th array of site i of generation g
+  std::string mf_filename(int i, long g, int k) const;
+
+  /// Write site arrays
+  void mf_write_site(const MpSite& site, int i, long g) const;
+
+  /// Write manifest atomically
+  void mf_write_manifest(const DmrgPosition& pos, const std::vector<long>& gen) const;
+
+  /// Remove files of site i of generation g
+  void mf_remove_site(int i, long g) const;
+
+  /// Remove site files in the directory of prefix, except for generation gen[i] of site i, and temporaries of interrupted writes
+  void mf_remove_stale(const std::vector<long>& gen) const;
+
+  std::string m_prefix;
+
+  /// Generation of the latest snapshot
+  long m_gen;
+
+  /// Generation of each site, in the latest snapshot
+  std::vector<long> m_site_gen;
+
+  /// Min. interval of snapshots
+  double m_interval;
+
+  /// Time of the last snapshot
+  std::chrono::steady_clock::time_point m_last;
+
+  /// Sites changed since the last snapshot
+  std::set<int> m_dirty;
+
+  /// Pending snapshot
+  std::future<void> m_io;
+};
+
+};
+
+#endif // _PROTOTYPE_CHECKPOINT_H
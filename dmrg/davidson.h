@@ -10,6 +10,7 @@
 #include <boost/bind.hpp>
 
 #include <legacy/QSPARSE/QSDArray.h>
+#include <legacy/QSPARSE/QSTdavidson.h>
 
 //#include "btas_template_specialize.h"
 
@@ -26,110 +27,29 @@ template<size_t N>
 void precondition
 (const double& eval, const btas::QSDArray<N>& diag, btas::QSDArray<N>& errv)
 {
-  for(auto ir = errv.begin(); ir != errv.end(); ++ir) {
-    auto id = diag.find(ir->first);
-    if(id != diag.end()) {
-      auto irx = ir->second->begin();
-      auto idx = id->second->begin();
-      for(; irx != ir->second->end(); ++irx, ++idx) {
-        double denm = eval - *idx;
-        if(fabs(denm) < 1.0e-12) denm = 1.0e-12;
-        *irx /= denm;
-      }
-    }
-    else {
-      btas::Dscal(1.0/eval, (*ir->second));
-    }
-  }
+  btas::QSTprecondition(eval, diag, errv);
 }
 
 //
 // Davidson eigen solver
 //
 
+/// If in_place is true, f_contract overwrites sigma vector given by the previous call, e.g. prototype::SigmaPipeline
+/// Defaults of tol (residual norm), max_subspace and max_iter are those of the former solver,
+/// i.e. |r|^2 < 1.0e-8 with 20 Ritz vectors and 20 restarts
 template<size_t N>
 double diagonalize
-(const Functor<N>& f_contract, const btas::QSDArray<N>& diag, btas::QSDArray<N>& wfnc)
+(const Functor<N>& f_contract, const btas::QSDArray<N>& diag, btas::QSDArray<N>& wfnc, bool in_place = false,
+ double tol = 1.0e-4, int max_subspace = 20, int max_iter = 400)
 {
-  int max_ritz = 20;
-
-  double eval = 0.0;
-
-  // reserve working space
-  std::vector<btas::QSDArray<N>> trial(max_ritz);
-  std::vector<btas::QSDArray<N>> sigma(max_ritz);
-
-  btas::QSDcopy(wfnc, trial[0]);
-  btas::Normalize(trial[0]);
-  f_contract(trial[0], sigma[0]);
-
-  int niter = 0;
-  int iconv = 0;
-  while(iconv < 1 && niter < 20) {
-    for(int m = 1; m <= max_ritz; ++m) {
-      // compute small Hamiltonian matrix
-      btas::DArray<2> heff(m, m);
-      btas::DArray<2> ovlp(m, m);
-      for(int i = 0; i < m; ++i) {
-        heff(i, i) = btas::QSDdotc(trial[i], sigma[i]);
-        ovlp(i, i) = btas::QSDdotc(trial[i], trial[i]);
-        for(int j = 0; j < i; ++j) {
-          double hij = btas::QSDdotc(trial[i], sigma[j]);
-          heff(i, j) = hij;
-          heff(j, i) = hij;
-          double sij = btas::QSDdotc(trial[i], trial[j]);
-          ovlp(i, j) = sij;
-          ovlp(j, i) = sij;
-        }
-      }
-      // solve eigenvalue problem to obtain Ritz value & vector
-      btas::DArray<2> rvec;
-      btas::DArray<1> rval;
-      Dsyev('V', 'U', heff, rval, rvec);
-      eval = rval(0);
-      // rotate trial & sigma vectors by Ritz vector
-      std::vector<btas::QSDArray<N>> trial_save(m);
-      std::vector<btas::QSDArray<N>> sigma_save(m);
-      for(int i = 0; i < m; ++i) {
-        btas::QSDcopy(trial[i], trial_save[i]);
-        btas::QSDcopy(sigma[i], sigma_save[i]);
-        btas::QSDscal(rvec(i, i), trial[i]);
-        btas::QSDscal(rvec(i, i), sigma[i]);
-      }
-      for(int i = 0; i < m; ++i) {
-        for(int j = 0; j < m; ++j) {
-          if(i != j) {
-            btas::QSDaxpy(rvec(i, j), trial_save[i], trial[j]);
-            btas::QSDaxpy(rvec(i, j), sigma_save[i], sigma[j]);
-          }
-        }
-      }
-      // compute error vector
-      btas::QSDArray<N> evec;
-      btas::QSDArray<N> errv;
-      btas::QSDcopy( trial[0], evec);
-      btas::QSDcopy( sigma[0], errv);
-      btas::QSDaxpy(-eval, evec, errv);
-      double rnorm = btas::QSDdotc(errv, errv);
-      if(rnorm < 1.0e-8) { ++iconv; break; }
-      // solve correction equation
-      if(m < max_ritz) {
-        precondition(eval, diag, errv);
-        for(int i = 0; i < m; ++i) {
-          btas::Normalize(errv);
-          btas::Orthogonalize(trial[i], errv);
-        }
-        btas::Normalize(errv);
-        btas::QSDcopy(errv, trial[m]);
-        sigma[m].clear();
-        f_contract(trial[m], sigma[m]);
-      }
-    }
-    ++niter;
-  }
-  btas::QSDcopy(trial[0], wfnc);
-
-  return eval;
+  // solver is kept to reuse trial & sigma vectors over sites, for each thread of real-space parallel sweeps,
+  // thus parameters are set for every call rather than at construction
+  static thread_local btas::QSTdavidson<double, N, btas::Quantum> solver;
+  solver.set_tol(tol);
+  solver.set_max_subspace(max_subspace);
+  solver.set_max_iter(max_iter);
+  solver.set_sigma_in_place(in_place);
+  return solver.solve(f_contract, diag, wfnc);
 }
 
 };
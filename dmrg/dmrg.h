@@ -2,12 +2,15 @@
 #define _PROTOTYPE_DMRG_H 1
 
 #include "mpsite.h"
+#include "mpstore.h"
+#include "checkpoint.h"
 
 namespace prototype {
 
 enum DMRG_ALGORITHM { ONESITE, TWOSITE };
 
 namespace Heisenberg { void construct_mpo(MpStorages& sites, int Nz, double J = 1.0, double Jz = 1.0, double Hz = 0.0); };
+namespace LongRangeHeisenberg { void construct_mpo(MpStorages& sites, double J = 1.0, double alpha = 1.0); };
 namespace Hubbard { void construct_mpo(MpStorages& sites, double t = 1.0, double U = 1.0); };
 
 void set_quantum_blocks(const MpStorages& sites, const btas::Quantum& qt, std::vector<btas::Qshapes<btas::Quantum>>& qb, int QMAX_SIZE = 0);
@@ -16,9 +19,46 @@ void initialize(MpStorages& sites, const btas::Quantum& qt, int M = 0);
 double optimize_onesite(bool forward, MpSite& sysdot, MpSite& envdot, int M = 0);
 double optimize_twosite(bool forward, MpSite& sysdot, MpSite& envdot, int M = 0);
 
-double dmrg_sweep(MpStorages& sites, DMRG_ALGORITHM algo, int M = 0);
+/// If store is given, only the sites being optimized are kept in memory, and the next site is prefetched
+/// If ckpt is given, changed sites and the position are saved after each step
+/// If pos is given, the sweep is resumed from there
+double dmrg_sweep(MpStorages& sites, DMRG_ALGORITHM algo, int M = 0, MpStore* store = 0, DmrgCheckpoint* ckpt = 0, DmrgPosition* pos = 0);
 
-double dmrg(MpStorages& sites, DMRG_ALGORITHM algo, int M = 0);
+/// If ckpt is given and has a checkpoint, sweeps are restarted from there, otherwise it starts from the current sites
+/// Note that a checkpoint is specific to algorithm and M, use different prefix for each dmrg call
+double dmrg(MpStorages& sites, DMRG_ALGORITHM algo, int M = 0, MpStore* store = 0, DmrgCheckpoint* ckpt = 0);
+
+/// Segments of chain for real-space parallel sweeps (E. M. Stoudenmire and S. R. White, PRB 87, 155137 (2013))
+/// At the boundary bond between segments k-1 and k, the wavefunction is stored as ... A Lambda V Lambda B ...,
+/// where A and B are the left- and right-canonical MPSs from the last SVD there, and V = Lambda^-1.
+/// Each segment is swept by its own thread, and the two-site wavefunction across the boundary is recovered
+/// from the centers of both segments as (A Lambda) V (Lambda B), when they meet there.
+struct DmrgSegments {
+  std::vector<int> begin;              ///< first site of each segment, and the number of sites at the last
+  std::vector<btas::SDArray<1>> vinv;  ///< V = Lambda^-1 at boundary k, between segments k-1 and k (vinv[0] is unused)
+  bool started;                        ///< false until the first sweep, in which all segments have center at the right end
+
+  DmrgSegments() : started(false) { }
+
+  int size() const { return begin.size()-1; }
+};
+
+/// Split sites into nseg segments of nearly equal length (>= 2 sites), and bring MPSs into the form of DmrgSegments
+/// Sites must have center at the first site with renormalized operators, as after initialize() or dmrg()
+/// Segments can't be combined with distributed sigma vector, since collectives would be called from several threads
+void split_segments(MpStorages& sites, int nseg, DmrgSegments& segs, int M = 0);
+
+/// Real-space parallel two-site sweep
+/// Even segments sweep forward while odd segments sweep backward, then boundaries where they meet are updated,
+/// and vice versa, so that each site is visited twice as in the sequential sweep.
+/// Segments and boundaries are distributed over OpenMP threads, thus it throws if sigma vector is distributed.
+double dmrg_sweep(MpStorages& sites, DmrgSegments& segs, int M = 0);
+
+/// Merge segments back to the form with center at the first site, which can be passed to the sequential dmrg()
+void merge_segments(MpStorages& sites, DmrgSegments& segs);
+
+/// Real-space parallel two-site DMRG with nseg segments, and sites are merged back at the end
+double dmrg_segmented(MpStorages& sites, int nseg, int M = 0);
 
 };
 
@@ -1,11 +1,26 @@
 #ifndef _PROTOTYPE_DRIVER_H
 #define _PROTOTYPE_DRIVER_H 1
 
+#include <vector>
+
 #include <legacy/QSPARSE/QSDArray.h>
 
+#include "mpoperator.h"
+
+#ifdef _HAS_MPI
+#include <boost/mpi/communicator.hpp>
+#endif
+
 namespace prototype
 {
 
+/// Canonicalization mode
+enum CANONICALIZE_MODE
+{
+  SVD_TRUNCATE, ///< SVD, keeping M largest singular values
+  QR_GAUGE      ///< QR (or LQ), which only changes gauge without truncation
+};
+
 void ComputeGuess
 (bool forward, const btas::QSDArray<3>& mps0,
                const btas::QSDArray<3>& wfn0,
@@ -14,12 +29,12 @@ void ComputeGuess
 
 void Canonicalize
 (bool forward, const btas::QSDArray<3>& wfn0,
-                     btas::QSDArray<3>& mps0, int M = 0);
+                     btas::QSDArray<3>& mps0, int M = 0, CANONICALIZE_MODE mode = SVD_TRUNCATE);
 
 void Canonicalize
 (bool forward, const btas::QSDArray<4>& wfnx,
                      btas::QSDArray<3>& mps0,
-                     btas::QSDArray<3>& wfn1, int M = 0);
+                     btas::QSDArray<3>& wfn1, int M = 0, CANONICALIZE_MODE mode = SVD_TRUNCATE);
 
 void Renormalize
 (bool forward, const btas::QSDArray<4>& mpo0,
@@ -28,6 +43,14 @@ void Renormalize
                const btas::QSDArray<3>& ket0,
                      btas::QSDArray<3>& opr1);
 
+/// Renormalization with operator-valued MPO, which skips zero pairs of MPO bond indices
+void Renormalize
+(bool forward, const MpOperator&        mpo0,
+               const btas::QSDArray<3>& opr0,
+               const btas::QSDArray<3>& bra0,
+               const btas::QSDArray<3>& ket0,
+                     btas::QSDArray<3>& opr1);
+
 void ComputeDiagonal
 (              const btas::QSDArray<4>& mpo0,
                const btas::QSDArray<3>& lopr,
@@ -56,6 +79,178 @@ void ComputeSigmaVector
                const btas::QSDArray<4>& wfn0,
                      btas::QSDArray<4>& sgv0);
 
+/// Sigma vector with operator-valued MPO, which skips zero pairs of MPO bond indices
+void ComputeSigmaVector
+(              const MpOperator&        mpo0,
+               const btas::QSDArray<3>& lopr,
+               const btas::QSDArray<3>& ropr,
+               const btas::QSDArray<3>& wfn0,
+                     btas::QSDArray<3>& sgv0);
+
+void ComputeSigmaVector
+(              const MpOperator&        lmpo,
+               const MpOperator&        rmpo,
+               const btas::QSDArray<3>& lopr,
+               const btas::QSDArray<3>& ropr,
+               const btas::QSDArray<4>& wfn0,
+                     btas::QSDArray<4>& sgv0);
+
+/// Sigma vectors of several wavefunctions at once
+/// Wavefunctions are stacked along batch index so that operator blocks are read once for all of them.
+void ComputeSigmaVectors
+(              const btas::QSDArray<4>& mpo0,
+               const btas::QSDArray<3>& lopr,
+               const btas::QSDArray<3>& ropr,
+               const std::vector<btas::QSDArray<3>>& wfn0,
+                     std::vector<btas::QSDArray<3>>& sgv0);
+
+void ComputeSigmaVectors
+(              const btas::QSDArray<4>& lmpo,
+               const btas::QSDArray<4>& rmpo,
+               const btas::QSDArray<3>& lopr,
+               const btas::QSDArray<3>& ropr,
+               const std::vector<btas::QSDArray<4>>& wfn0,
+                     std::vector<btas::QSDArray<4>>& sgv0);
+
+void ComputeSigmaVectors
+(              const MpOperator&        mpo0,
+               const btas::QSDArray<3>& lopr,
+               const btas::QSDArray<3>& ropr,
+               const std::vector<btas::QSDArray<3>>& wfn0,
+                     std::vector<btas::QSDArray<3>>& sgv0);
+
+void ComputeSigmaVectors
+(              const MpOperator&        lmpo,
+               const MpOperator&        rmpo,
+               const btas::QSDArray<3>& lopr,
+               const btas::QSDArray<3>& ropr,
+               const std::vector<btas::QSDArray<4>>& wfn0,
+                     std::vector<btas::QSDArray<4>>& sgv0);
+
+/// Sigma vector with preallocated intermediates and contraction plans, N = 3 for one-site and N = 4 for two-site
+/// Operators and shape of wavefunction are fixed at construction, e.g. for Davidson iterations at one site.
+/// If memory budget is set, the chain is planned for each chunk of left MPO bond index, sharing intermediates.
+/// Since MPO bond and physical indices are 1-dimensional (see MpOperator), every block of intermediates is
+/// a (left bond) x (right bond) matrix, and the contraction chain is planned as lists of block GEMMs and axpys
+/// onto preallocated buffers, which are done in parallel over resulting blocks.
+/// apply() doesn't allocate, as long as sgv has the blocks given by the previous apply(),
+/// except for communication buffers in distributed mode.
+/// Blocks of lopr and ropr are referred, not copied, thus they must be alive and unchanged while the pipeline is used.
+template<size_t N>
+class SigmaPipeline {
+public:
+  /// One-site
+  SigmaPipeline
+  (              const MpOperator&        mpo0,
+                 const btas::QSDArray<3>& lopr,
+                 const btas::QSDArray<3>& ropr,
+                 const btas::QSDArray<N>& wfn0);
+
+  /// Two-site
+  SigmaPipeline
+  (              const MpOperator&        lmpo,
+                 const MpOperator&        rmpo,
+                 const btas::QSDArray<3>& lopr,
+                 const btas::QSDArray<3>& ropr,
+                 const btas::QSDArray<N>& wfn0);
+
+  /// sgv = H * wfn, where sgv is overwritten, or reallocated if it doesn't have the planned blocks
+  /// In distributed mode, sgv is summed over ranks in place, thus every rank must call it in the same order
+  /// wfn must have the same shape of wfn0, and blocks which are not in wfn are taken as zero
+  void apply(const btas::QSDArray<N>& wfn, btas::QSDArray<N>& sgv);
+
+private:
+  /// Block GEMM, c += a * b for the first step or c += a * b^T for the last step, where block of wfn or sgv is given by index at apply()
+  struct GemmTask {
+    const double* a;
+    const double* b;
+    double* c;
+    int index;
+    size_t m;
+    size_t n;
+    size_t k;
+  };
+
+  /// Block axpy by MPO element
+  struct AxpyTask {
+    const double* x;
+    double* y;
+    size_t n;
+    double alpha;
+  };
+
+  /// Tasks of each step for a chunk, and their groups which have the same resulting block
+  struct Plan {
+    std::vector<GemmTask> first;
+    std::vector<size_t> first_group;
+    std::vector<std::vector<AxpyTask>> axpy;
+    std::vector<std::vector<size_t>> axpy_group;
+    std::vector<GemmTask> last;
+    std::vector<size_t> last_group;
+  };
+
+  void mf_plan(std::vector<const MpOperator*> mpos, const btas::QSDArray<3>& lopr, const btas::QSDArray<3>& ropr, const btas::QSDArray<N>& wfn0);
+
+  /// Returns true if sgv has the planned blocks, and stores their pointers
+  bool mf_check_output(btas::QSDArray<N>& sgv);
+
+  /// Shape of wfn
+  btas::Quantum m_q_wfn;
+  btas::TVector<btas::Qshapes<btas::Quantum>, N> m_qshape_wfn;
+  btas::TVector<btas::Dshapes, N> m_dshape_wfn;
+
+  /// Shape of sgv
+  btas::Quantum m_q_sgv;
+  btas::TVector<btas::Qshapes<btas::Quantum>, N> m_qshape_sgv;
+  btas::TVector<btas::Dshapes, N> m_dshape_sgv;
+
+  /// Tags of blocks of wfn and sgv in the plan, and pointers to them in the current apply()
+  /// In distributed mode, sgv has the union of blocks over ranks
+  std::vector<int> m_wfn_tags;
+  std::vector<const double*> m_wfn_ptrs;
+  std::vector<int> m_sgv_tags;
+  std::vector<double*> m_sgv_ptrs;
+  std::vector<size_t> m_sgv_sizes;
+  std::vector<size_t> m_sgv_offset;
+
+  /// Blocks of sgv which are not computed on this rank, indices to m_sgv_tags
+  std::vector<size_t> m_sgv_zero;
+
+  /// Intermediates, one for each step, shared among chunks
+  std::vector<std::vector<double>> m_buffer;
+
+  /// Plans for chunks of left MPO bond index, see SetMemoryBudget
+  std::vector<Plan> m_plans;
+
+  /// True if sgv is summed over ranks
+  bool m_distributed;
+
+  /// Slice of lopr in distributed mode, to which the plan refers
+  btas::QSDArray<3> m_lopr_slice;
+
+  /// Buffers to sum sgv over ranks in distributed mode
+  std::vector<double> m_comm_send;
+  std::vector<double> m_comm_recv;
+};
+
+/// Set memory budget in bytes for intermediates of sigma vector, 0 (default) for unlimited
+/// Contraction is sliced along MPO bond index of lopr into contiguous chunks, and partial results are accumulated chunk by chunk.
+/// Chunk size is chosen from block shapes of lopr, wfn, and MPO, so that intermediates of each chunk are estimated to fit in the budget,
+/// while a chunk has at least one block, thus the budget can be exceeded by a single large block.
+void SetMemoryBudget(size_t bytes);
+
+/// True if sigma vector and renormalization are distributed over processes, see SetCommunicator
+/// Then, they communicate, and must be called in the same order on every process, not concurrently.
+bool IsDistributed();
+
+#ifdef _HAS_MPI
+/// Distribute sigma vector and renormalization over MPO bond index
+/// Each rank contracts its slice of left (or right, for backward renormalization) MPO bond index of operators and MPO,
+/// and partial results are summed up over ranks, thus every rank has the same sigma vector and renormalized operators.
+/// All ranks must call the drivers in the same order, e.g. by running the same DMRG sweeps.
+void SetCommunicator(const boost::mpi::communicator& world);
+#endif
+
 };
 
 #endif // _PROTOTYPE_DRIVER_H
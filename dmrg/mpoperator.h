@@ -0,0 +1,181 @@
+#ifndef _PROTOTYPE_MPOPERATOR_H
+#define _PROTOTYPE_MPOPERATOR_H 1
+
+#include <vector>
+#include <algorithm>
+
+#include <legacy/DENSE/DArray.h>
+#include <legacy/QSPARSE/QSDArray.h>
+
+namespace prototype {
+
+/// Operator-valued MPO
+/// MPO W(l, n', n, r) is stored as a list of terms, one for each non-zero pair of bond indices (l, r),
+/// and each term holds a single-site operator O(n', n) tagged as
+///   IDENTITY : O = I
+///   SCALAR   : O = c I
+///   DENSE    : O is a small dense matrix
+/// so that zero pairs, which are most of (l, r) pairs, are never touched in contractions.
+/// Bond and physical indices must consist of 1-dimensional blocks, as MPOs constructed in this prototype.
+class MpOperator {
+public:
+  enum OPERATOR_TYPE { IDENTITY, SCALAR, DENSE };
+
+  struct Term {
+    int l;               ///< left bond index
+    int r;               ///< right bond index
+    OPERATOR_TYPE type;
+    double scale;        ///< c for SCALAR, 1 for IDENTITY and DENSE
+    btas::DArray<2> op;  ///< O(n', n), only for DENSE
+  };
+
+  MpOperator() { }
+
+  explicit MpOperator(const btas::QSDArray<4>& mpo) { assign(mpo); }
+
+  /// Build terms from block-sparse MPO
+  void assign(const btas::QSDArray<4>& mpo);
+
+  /// Returns terms owned by rank, in which bond index i (0 or 3) is distributed as btas::QSTslice does
+  MpOperator slice(int i, int rank, int nproc) const;
+
+  /// Returns terms of which bond index i (0 or 3) is in indxs, renumbered in order of indxs as QSTArray::subarray does
+  MpOperator slice(int i, const std::vector<int>& indxs) const;
+
+  void clear();
+
+  /// Returns true if not assigned
+  bool empty() const { return m_q_shape[0].empty(); }
+
+  const std::vector<Term>& terms() const { return m_terms; }
+
+  const btas::Quantum& q() const { return m_q_total; }
+  const btas::TVector<btas::Qshapes<btas::Quantum>, 4>& qshape() const { return m_q_shape; }
+  const btas::Qshapes<btas::Quantum>& qshape(int i) const { return m_q_shape[i]; }
+  const btas::TVector<btas::Dshapes, 4>& dshape() const { return m_d_shape; }
+
+private:
+  btas::Quantum m_q_total;
+
+  btas::TVector<btas::Qshapes<btas::Quantum>, 4> m_q_shape;
+
+  btas::TVector<btas::Dshapes, 4> m_d_shape;
+
+  std::vector<Term> m_terms;
+};
+
+/// Contract x and MPO over 2 indices, which gives the same result as btas::QSDcontract with the block-sparse MPO
+/// y's indices are the rest of x followed by the rest of MPO, in order.
+/// Since contracted and resulting MPO indices are 1-dimensional, y's block has the same layout of x's block,
+/// thus each non-zero element of MPO is an axpy of blocks, done in parallel over blocks of y.
+template<size_t N>
+void MpOcontract
+(const double& alpha, const btas::QSDArray<N>& x, const btas::IVector<2>& idx_x,
+                      const MpOperator&        w, const btas::IVector<2>& idx_w,
+ const double& beta,        btas::QSDArray<N>& y)
+{
+  BTAS_THROW(!w.empty(), "prototype::MpOcontract: MPO is not assigned");
+
+  // indices kept in y
+  btas::IVector<N-2> kept_x;
+  for(int i = 0, k = 0; i < N; ++i)
+    if(i != idx_x[0] && i != idx_x[1]) kept_x[k++] = i;
+  btas::IVector<2> kept_w;
+  for(int i = 0, k = 0; i < 4; ++i)
+    if(i != idx_w[0] && i != idx_w[1]) kept_w[k++] = i;
+
+  btas::Quantum qy = w.q() * x.q();
+  btas::TVector<btas::Qshapes<btas::Quantum>, N> qshape_y;
+  btas::TVector<btas::Dshapes, N> dshape_y;
+  for(int k = 0; k < N-2; ++k) {
+    qshape_y[k] = x.qshape(kept_x[k]);
+    dshape_y[k] = x.dshape(kept_x[k]);
+  }
+  for(int k = 0; k < 2; ++k) {
+    qshape_y[N-2+k] = w.qshape(kept_w[k]);
+    dshape_y[N-2+k] = w.dshape()[kept_w[k]];
+  }
+
+  if(y.size() > 0) {
+    BTAS_THROW(y.q() == qy, "prototype::MpOcontract: quantum number of y must equal to x.q() + w.q()");
+    BTAS_THROW(y.qshape() == qshape_y, "prototype::MpOcontract: y must have the same quantum shape of [ x * w ]");
+    btas::QSDscal(beta, y);
+  }
+  else {
+    y.resize(qy, qshape_y, dshape_y, false);
+  }
+
+  // non-zero elements of MPO, looked up by contracted indices
+  struct Element { int i0; int i1; double value; };
+  const int nw0 = w.qshape(idx_w[0]).size();
+  const int nw1 = w.qshape(idx_w[1]).size();
+  std::vector<std::vector<Element>> table(nw0*nw1);
+  for(auto t = w.terms().begin(); t != w.terms().end(); ++t) {
+    btas::IVector<4> iw;
+    iw[0] = t->l;
+    iw[3] = t->r;
+    if(t->type == MpOperator::DENSE) {
+      for(int i = 0; i < t->op.shape(0); ++i)
+        for(int j = 0; j < t->op.shape(1); ++j) {
+          if(t->op(i, j) == 0.0) continue;
+          iw[1] = i;
+          iw[2] = j;
+          table[iw[idx_w[0]]*nw1+iw[idx_w[1]]].push_back(Element { iw[kept_w[0]], iw[kept_w[1]], t->op(i, j) });
+        }
+    }
+    else {
+      for(int i = 0; i < w.qshape(1).size(); ++i) {
+        iw[1] = i;
+        iw[2] = i;
+        table[iw[idx_w[0]]*nw1+iw[idx_w[1]]].push_back(Element { iw[kept_w[0]], iw[kept_w[1]], t->scale });
+      }
+    }
+  }
+
+  // collecting axpy tasks, allocation is done serially since it modifies std::map
+  struct Task { double* py; const double* px; size_t n; double alpha; };
+  std::vector<Task> task;
+  for(auto xi = x.begin(); xi != x.end(); ++xi) {
+    btas::IVector<N> ix = x.index(xi->first);
+    const std::vector<Element>& elems = table[ix[idx_x[0]]*nw1+ix[idx_x[1]]];
+    if(elems.empty()) continue;
+    btas::IVector<N> iy;
+    for(int k = 0; k < N-2; ++k) iy[k] = ix[kept_x[k]];
+    for(auto e = elems.begin(); e != elems.end(); ++e) {
+      iy[N-2] = e->i0;
+      iy[N-1] = e->i1;
+      auto yi = y.reserve(iy);
+      if(yi == y.end()) continue;
+      BTAS_THROW(yi->second->size() == xi->second->size(), "prototype::MpOcontract: MPO must have 1-dimensional blocks");
+      task.push_back(Task { yi->second->data(), xi->second->data(), xi->second->size(), alpha*e->value });
+    }
+  }
+
+  // tasks on the same block of y are done by the same thread
+  std::stable_sort(task.begin(), task.end(), [] (const Task& a, const Task& b) { return a.py < b.py; });
+  std::vector<size_t> group(1, 0);
+  for(size_t i = 1; i < task.size(); ++i)
+    if(task[i].py != task[i-1].py) group.push_back(i);
+  group.push_back(task.size());
+
+  size_t ngroup = group.size()-1;
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+  for(size_t g = 0; g < ngroup; ++g) {
+    for(size_t i = group[g]; i < group[g+1]; ++i) {
+            double* __restrict py = task[i].py;
+      const double* __restrict px = task[i].px;
+      const double a = task[i].alpha;
+      const size_t n = task[i].n;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+      for(size_t k = 0; k < n; ++k) py[k] += a * px[k];
+    }
+  }
+}
+
+};
+
+#endif // _PROTOTYPE_MPOPERATOR_H
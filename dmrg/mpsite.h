@@ -5,6 +5,8 @@
 
 #include <legacy/QSPARSE/QSDArray.h>
 
+#include "mpoperator.h"
+
 namespace prototype {
 
 struct MpSite {
@@ -13,6 +15,11 @@ struct MpSite {
   //
   btas::QSDArray<4> mpo;
 
+  //
+  // operator-valued MPO, built from mpo, which is used for sigma vector and renormalization
+  //
+  MpOperator opmpo;
+
   //
   // matrix product state (MPS) / left-canonical / right-canonical / wavefunction at this site
   //
@@ -0,0 +1,77 @@
+#ifndef _PROTOTYPE_MPSTORE_H
+#define _PROTOTYPE_MPSTORE_H 1
+
+#include <vector>
+#include <string>
+#include <future>
+
+#include "mpsite.h"
+
+namespace prototype {
+
+/// Disk-backed storage of sites
+/// MPS and renormalized operators, whose sizes scale as M^2, of inactive sites are spilled to local files and released.
+/// MPO is small and always kept in memory.
+/// Arrays are stored in block-sparse binary format (QSTfile.h), and I/O is done on background threads:
+///   - prefetch(i) starts reading site i, which is waited by load(i)
+///   - unload(i) starts writing site i, and releases memory when it's done
+/// In the DMRG sweep, at most 4 sites (sysdot, envdot, prefetched and being written) are resident,
+/// thus memory doesn't grow with chain length.
+class MpStore {
+public:
+  /// \param prefix path prefix of files, e.g. "/scratch/mpsite", files are named as prefix.i.lmps and so on
+  ///        If built with MPI, rank is appended as prefix.rankN, since every rank has its own sites
+  MpStore(MpStorages& sites, const std::string& prefix = "mpsite");
+
+  /// Wait for pending I/O and remove files
+  /// Spilled sites are NOT loaded back, call load_all() before destruction if they're needed
+ ~MpStore();
+
+  /// Make site i resident, waiting for prefetch if in progress
+  void load(int i);
+
+  /// Start reading site i in background, do nothing if i is out of range or already resident
+  void prefetch(int i);
+
+  /// Start writing site i in background, and release it when written
+  void unload(int i);
+
+  /// Load all sites
+  void load_all();
+
+  /// Unload all sites
+  void unload_all();
+
+  /// Returns true if site i is resident (or being prefetched)
+  bool resident(int i) const { return m_resident[i]; }
+
+  /// Number of sites
+  int size() const { return m_sites.size(); }
+
+private:
+  /// Wait for pending I/O of site i, exceptions thrown from I/O are re-thrown here
+  void mf_wait(int i);
+
+  /// File name for k-th array of site i
+  std::string mf_filename(int i, int k) const;
+
+  /// Write site i to file and release its memory
+  void mf_write(int i);
+
+  /// Read site i from file
+  void mf_read(int i);
+
+  MpStorages& m_sites;
+
+  std::string m_prefix;
+
+  /// Resident flag for each site
+  std::vector<bool> m_resident;
+
+  /// Pending I/O for each site
+  std::vector<std::future<void>> m_io;
+};
+
+};
+
+#endif // _PROTOTYPE_MPSTORE_H
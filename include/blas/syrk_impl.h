@@ -0,0 +1,91 @@
+#ifndef __BTAS_BLAS_SYRK_IMPL_H
+#define __BTAS_BLAS_SYRK_IMPL_H
+
+#include <blas/types.h>
+
+namespace btas {
+
+template<typename T>
+void syrk (
+  const CBLAS_ORDER& order,
+  const CBLAS_UPLO& uplo,
+  const CBLAS_TRANSPOSE& trans,
+  const size_t& N,
+  const size_t& K,
+  const T& alpha,
+  const T* A,
+  const size_t& ldA,
+  const T& beta,
+        T* C,
+  const size_t& ldC)
+{
+  BTAS_ASSERT(false, "syrk is not implemented.");
+}
+
+inline void syrk (
+  const CBLAS_ORDER& order,
+  const CBLAS_UPLO& uplo,
+  const CBLAS_TRANSPOSE& trans,
+  const size_t& N,
+  const size_t& K,
+  const float& alpha,
+  const float* A,
+  const size_t& ldA,
+  const float& beta,
+        float* C,
+  const size_t& ldC)
+{
+  cblas_ssyrk(order, uplo, trans, N, K, alpha, A, ldA, beta, C, ldC);
+}
+
+inline void syrk (
+  const CBLAS_ORDER& order,
+  const CBLAS_UPLO& uplo,
+  const CBLAS_TRANSPOSE& trans,
+  const size_t& N,
+  const size_t& K,
+  const double& alpha,
+  const double* A,
+  const size_t& ldA,
+  const double& beta,
+        double* C,
+  const size_t& ldC)
+{
+  cblas_dsyrk(order, uplo, trans, N, K, alpha, A, ldA, beta, C, ldC);
+}
+
+inline void syrk (
+  const CBLAS_ORDER& order,
+  const CBLAS_UPLO& uplo,
+  const CBLAS_TRANSPOSE& trans,
+  const size_t& N,
+  const size_t& K,
+  const std::complex<float>& alpha,
+  const std::complex<float>* A,
+  const size_t& ldA,
+  const std::complex<float>& beta,
+        std::complex<float>* C,
+  const size_t& ldC)
+{
+  cblas_csyrk(order, uplo, trans, N, K, &alpha, A, ldA, &beta, C, ldC);
+}
+
+inline void syrk (
+  const CBLAS_ORDER& order,
+  const CBLAS_UPLO& uplo,
+  const CBLAS_TRANSPOSE& trans,
+  const size_t& N,
+  const size_t& K,
+  const std::complex<double>& alpha,
+  const std::complex<double>* A,
+  const size_t& ldA,
+  const std::complex<double>& beta,
+        std::complex<double>* C,
+  const size_t& ldC)
+{
+  cblas_zsyrk(order, uplo, trans, N, K, &alpha, A, ldA, &beta, C, ldC);
+}
+
+} // namespace btas
+
+#endif // __BTAS_BLAS_SYRK_IMPL_H
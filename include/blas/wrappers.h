@@ -9,6 +9,7 @@
 #include <blas/gemv_impl.h>
 #include <blas/ger_impl.h>
 #include <blas/gemm_impl.h>
+#include <blas/syrk_impl.h>
 #include <blas/scal_impl.h>
 
 #endif // __BTAS_BLAS_WRAPPERS_H
@@ -2,12 +2,17 @@
 #define __BTAS_BLOCK_SPARSE_TENSOR_HPP
 
 #include <vector>
+#include <numeric>
+#include <functional>
 
 #include <boost/array.hpp>
 #include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <btas/Tensor.hpp>
+#include <btas/TensorWrapper.hpp>
 #include <btas/SpTensor.hpp>
+#include <btas/Sp/SpShmWindow.hpp>
 
 namespace btas {
 
@@ -20,6 +25,8 @@ public:
 
   typedef Tensor<T,N,Order> block_type;
 
+  typedef TensorWrapper<const T*,N,Order> const_wrapper_type;
+
 private:
 
   typedef SpTensor<block_type,N,Q,Order> base_;
@@ -50,18 +57,27 @@ public:
     IndexedFor<1,N,Order>::loop(base_::extent(),idx_,boost::bind(&BlockSpTensor::make_block_,boost::ref(*this),&ord_,_1));
   }
 
+  /// copy constructor, shared-memory window is not copied since it holds a snapshot of x
   BlockSpTensor(const BlockSpTensor& x)
   : base_(x), size_shape_(x.size_shape_)
   { }
 
+  /// window of this is unmapped, but kept to be reused by shm_publish() or freed by shm_release()
   BlockSpTensor& operator= (const BlockSpTensor& x)
   {
     base_::operator=(x);
     size_shape_ = x.size_shape_;
+#ifndef _SERIAL
+    this->shm_unmap_();
+#endif
+    return *this;
   }
 
   void resize (const qnum_type& q0, const qnum_shape_type& qs, const size_shape_type& ss)
   {
+#ifndef _SERIAL
+    this->shm_unmap_();
+#endif
     base_::resize(q0,qs);
 
     size_shape_ = ss;
@@ -77,16 +93,98 @@ public:
   const size_array_type& size_array (size_t i) const
   { return size_shape_[i]; }
 
+  /// return extent of block specified by ordinal index i
+  typename block_type::extent_type block_extent (size_t i) const
+  {
+    index_type idx_ = base_::index(i);
+    typename block_type::extent_type exts;
+    for(size_t d = 0; d < N; ++d) exts[d] = size_shape_[d][idx_[d]];
+    return exts;
+  }
+
+  /// return view of block i accessible w/o communication,
+  /// i.e. stored in local proc., cached by get(...), or mapped on shared-memory window
+  /// \return false if block i cannot be accessed from this proc.
+  bool get_view (size_t i, const_wrapper_type& x) const
+  {
+#ifndef _SERIAL
+    if(this->is_shm_mapped(i) && !base_::is_local(i)) {
+      x.reset(shm_->segment(base_::where(i))+shm_offset_[i],this->block_extent(i));
+      return true;
+    }
+#endif
+    const_iterator it = base_::find_cache(i);
+    if(it == base_::end()) return false;
+
+    x.reset(it->data(),it->extent());
+    return true;
+  }
+
+#ifndef _SERIAL
+  /// publish local blocks on MPI-3 shared-memory window (collective)
+  /// after this, blocks stored on the same node can be read w/o messaging via get_view(...)
+  /// NOTE: window holds a snapshot of blocks, this must be called again after modifying them
+  /// NOTE: window must be freed by shm_release() on every proc., before this is destructed
+  void shm_publish ()
+  {
+    if(!shm_) shm_.reset(new SpShmWindow<T>(base_::world_));
+
+    // offsets of blocks in the segment of each proc. are determined from shape, w/o communication
+    std::vector<size_t> top_(base_::world_.size(),0);
+    shm_offset_.assign(base_::size(),0);
+    for(size_t i = 0; i < base_::size(); ++i) {
+      if(!base_::has(i)) continue;
+      typename block_type::extent_type exts = this->block_extent(i);
+      shm_offset_[i] = top_[base_::where(i)];
+      top_[base_::where(i)] += std::accumulate(exts.begin(),exts.end(),1ul,std::multiplies<size_t>());
+    }
+
+    T* seg_ = shm_->allocate(top_[base_::world_.rank()]);
+    for(size_t i = 0; i < base_::size(); ++i)
+      if(base_::is_local(i)) std::copy((*this)[i].begin(),(*this)[i].end(),seg_+shm_offset_[i]);
+
+    shm_->sync();
+  }
+
+  /// release shared-memory window (collective)
+  /// this is the only place where window is freed, assignment, resize, clear, and destructor only unmap blocks locally
+  void shm_release ()
+  {
+    if(shm_) shm_->release();
+    shm_.reset();
+    this->shm_unmap_();
+  }
+
+  /// whether block i is stored on the same node as proc. to_, and is mapped on shared-memory window
+  bool is_shm_mapped (size_t i, size_t to_) const
+  { return (shm_ && !shm_offset_.empty() && base_::has(i) && shm_->is_same_node(base_::where(i),to_)); }
+
+  /// whether block i is mapped on shared-memory window for this proc.
+  bool is_shm_mapped (size_t i) const
+  { return this->is_shm_mapped(i,base_::world_.rank()); }
+#else
+  bool is_shm_mapped (size_t i, size_t to_) const { return false; }
+
+  bool is_shm_mapped (size_t i) const { return false; }
+#endif
+
   void clear ()
   {
     base_::clear();
     for(size_t i = 0; i < N; ++i) size_shape_[i].clear();
+#ifndef _SERIAL
+    this->shm_unmap_();
+#endif
   }
 
   void swap (BlockSpTensor& x)
   {
     base_::swap(x);
     std::swap(size_shape_,x.size_shape_);
+#ifndef _SERIAL
+    shm_.swap(x.shm_);
+    shm_offset_.swap(x.shm_offset_);
+#endif
   }
 
   void fill (const value_type& value)
@@ -98,10 +196,16 @@ public:
 
 private:
 
+#ifndef _SERIAL
+  /// stop mapping blocks on window, w/o communication
+  void shm_unmap_ ()
+  { shm_offset_.clear(); }
+#endif
+
   void make_block_ (size_t* ord_, const index_type& idx_)
   {
     // For OpenMP, ord_ with private attribute
-    if(*ord_ == 0) *ord_ = shape_.ordinal(idx_);
+    if(*ord_ == 0) *ord_ = base_::shape_.ordinal(idx_);
 
     if(base_::is_local((*ord_))) {
       typename block_type::extent_type exts;
@@ -115,6 +219,12 @@ private:
 
   size_shape_type size_shape_;
 
+#ifndef _SERIAL
+  boost::shared_ptr<SpShmWindow<T>> shm_; ///< shared-memory window among procs. on the same node
+
+  std::vector<size_t> shm_offset_; ///< offset of each block in the segment of its owner, empty if blocks are not mapped
+#endif
+
 }; // class BlockSpTensor
 
 } // namespace btas
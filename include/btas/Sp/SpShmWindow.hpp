@@ -0,0 +1,133 @@
+#ifndef __BTAS_SPARSE_SHM_WINDOW_HPP
+#define __BTAS_SPARSE_SHM_WINDOW_HPP
+
+#ifndef _SERIAL
+
+#include <vector>
+
+#include <mpi.h>
+#include <boost/mpi.hpp>
+
+#include <btas/BTAS_ASSERT.h>
+
+namespace btas {
+
+/// MPI-3 shared-memory window among procs. on the same node
+/// Each proc. owns a segment of the window, which can directly be read by the other procs. on the same node.
+/// Window and node communicator must be freed by release(), which is collective.
+/// Destructor never makes collective calls, since it may run on some procs. only (e.g. during stack unwinding),
+/// thus handles which are not released are left to MPI_Finalize.
+/// \tparam T value type stored in segments
+template<typename T>
+class SpShmWindow {
+
+private:
+
+  typedef boost::mpi::communicator world_type;
+
+public:
+
+  /// create node communicator from world (collective)
+  explicit
+  SpShmWindow (const world_type& world)
+  : node_(MPI_COMM_NULL), win_(MPI_WIN_NULL)
+  {
+    MPI_Comm_split_type(world,MPI_COMM_TYPE_SHARED,world.rank(),MPI_INFO_NULL,&node_);
+
+    int nsize; MPI_Comm_size(node_,&nsize);
+
+    // node ID is given by world rank of node master
+    int master = world.rank();
+    MPI_Bcast(&master,1,MPI_INT,0,node_);
+    boost::mpi::all_gather(world,master,node_id_);
+
+    // map world rank to node rank
+    int me = world.rank();
+    std::vector<int> members(nsize);
+    MPI_Allgather(&me,1,MPI_INT,members.data(),1,MPI_INT,node_);
+    node_rank_.resize(world.size(),-1);
+    for(int i = 0; i < nsize; ++i) node_rank_[members[i]] = i;
+  }
+
+ ~SpShmWindow () { }
+
+  /// whether procs. p and q (world ranks) are on the same node
+  bool is_same_node (size_t p, size_t q) const { return node_id_[p] == node_id_[q]; }
+
+  /// allocate segment of local proc. with n elements (collective over node), and return pointer to it
+  T* allocate (size_t n)
+  {
+    this->free();
+
+    T* base;
+    MPI_Win_allocate_shared(n*sizeof(T),sizeof(T),MPI_INFO_NULL,node_,&base,&win_);
+    // passive target epoch is kept open during life of the window
+    MPI_Win_lock_all(MPI_MODE_NOCHECK,win_);
+
+    int nsize; MPI_Comm_size(node_,&nsize);
+    segments_.resize(nsize);
+    for(int i = 0; i < nsize; ++i) {
+      MPI_Aint size_;
+      int disp_;
+      MPI_Win_shared_query(win_,i,&size_,&disp_,&segments_[i]);
+    }
+    return base;
+  }
+
+  /// return segment owned by proc. p (world rank), which must be on the same node
+  const T* segment (size_t p) const
+  {
+    BTAS_ASSERT(node_rank_[p] >= 0,"SpShmWindow::segment, proc. is not on the same node.");
+    return segments_[node_rank_[p]];
+  }
+
+  /// make data written in local segment visible to the other procs. on the node (collective over node)
+  void sync ()
+  {
+    MPI_Win_sync(win_);
+    MPI_Barrier(node_);
+    MPI_Win_sync(win_);
+  }
+
+  /// deallocate window (collective over node)
+  void free ()
+  {
+    if(win_ == MPI_WIN_NULL) return;
+    MPI_Win_unlock_all(win_);
+    MPI_Win_free(&win_);
+    segments_.clear();
+  }
+
+  /// deallocate window and node communicator (collective over world)
+  void release ()
+  {
+    this->free();
+    if(node_ != MPI_COMM_NULL) MPI_Comm_free(&node_);
+  }
+
+private:
+
+  // non-copyable
+  SpShmWindow (const SpShmWindow&);
+
+  SpShmWindow& operator= (const SpShmWindow&);
+
+  // member variables
+
+  MPI_Comm node_; ///< communicator among procs. on the same node
+
+  MPI_Win win_; ///< shared-memory window
+
+  std::vector<int> node_id_; ///< node ID for each world rank
+
+  std::vector<int> node_rank_; ///< node rank for each world rank (-1 if on the other node)
+
+  std::vector<T*> segments_; ///< base pointers to segments for each node rank
+
+}; // class SpShmWindow
+
+} // namespace btas
+
+#endif // _SERIAL
+
+#endif // __BTAS_SPARSE_SHM_WINDOW_HPP
@@ -0,0 +1,73 @@
+#ifndef __BTAS_SPARSE_COMM_IMPL_HPP
+#define __BTAS_SPARSE_COMM_IMPL_HPP
+
+#ifndef _SERIAL
+
+#include <boost/mpi.hpp>
+
+#include <btas/Tensor.hpp>
+
+namespace btas {
+
+/// Whether object is sent as raw contiguous array instead of Boost.Serialization archive
+template<class Tn>
+struct Sp_is_raw_block_ { static const bool value = false; };
+
+/// Dense tensor of MPI datatype is sent as raw contiguous array
+template<typename T, size_t N, CBLAS_ORDER Order>
+struct Sp_is_raw_block_<Tensor<T,N,Order>> { static const bool value = boost::mpi::is_mpi_datatype<T>::value; };
+
+/// Communication of sparse tensor elements
+/// Generic objects are transferred via Boost.Serialization
+template<class Tn, bool = Sp_is_raw_block_<Tn>::value>
+struct Sp_comm_impl {
+
+  static void send (const boost::mpi::communicator& world, int dest, int tag, const Tn& x)
+  { world.send(dest,tag,x); }
+
+  static void recv (const boost::mpi::communicator& world, int source, int tag, Tn& x)
+  { world.recv(source,tag,x); }
+
+  static void broadcast (const boost::mpi::communicator& world, Tn& x, int root)
+  { boost::mpi::broadcast(world,x,root); }
+};
+
+/// Specialized for dense tensor of MPI datatype
+/// Extents are transferred as a small header, then the payload is transferred straight from data()
+template<typename T, size_t N, CBLAS_ORDER Order>
+struct Sp_comm_impl<Tensor<T,N,Order>,true> {
+
+  typedef Tensor<T,N,Order> tensor_type;
+
+  typedef typename tensor_type::extent_type extent_type;
+
+  static void send (const boost::mpi::communicator& world, int dest, int tag, const tensor_type& x)
+  {
+    // messages with the same (source, tag) are never overtaken
+    world.send(dest,tag,x.extent().data(),N);
+    world.send(dest,tag,x.data(),x.size());
+  }
+
+  static void recv (const boost::mpi::communicator& world, int source, int tag, tensor_type& x)
+  {
+    extent_type exts;
+    world.recv(source,tag,exts.data(),N);
+    x.resize(exts);
+    world.recv(source,tag,x.data(),x.size());
+  }
+
+  static void broadcast (const boost::mpi::communicator& world, tensor_type& x, int root)
+  {
+    extent_type exts;
+    if(world.rank() == root) exts = x.extent();
+    boost::mpi::broadcast(world,exts.data(),N,root);
+    if(world.rank() != root) x.resize(exts);
+    boost::mpi::broadcast(world,x.data(),x.size(),root);
+  }
+};
+
+} // namespace btas
+
+#endif // _SERIAL
+
+#endif // __BTAS_SPARSE_COMM_IMPL_HPP
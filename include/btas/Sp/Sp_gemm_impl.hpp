@@ -1,6 +1,8 @@
 #ifndef __BTAS_SPARSE_GEMM_IMPL_HPP
 #define __BTAS_SPARSE_GEMM_IMPL_HPP
 
+#include <cmath>
+#include <vector>
 #include <algorithm>
 #include <numeric>
 
@@ -10,6 +12,19 @@
 #endif
 
 #include <btas/BTAS_ASSERT.h>
+#include <blas/types.h>
+
+namespace btas {
+
+// declared before the headers below, since SpTensorBlas.hpp needs them while BlockSpTensor.hpp is read
+
+template<typename T, size_t N, class Q, CBLAS_ORDER Order> class BlockSpTensor;
+
+/// Only for BlockSpTensor
+template<typename Scalar, typename Tp, size_t L, size_t M, size_t N, class Q, CBLAS_ORDER Order> struct Sp_gemm_impl;
+
+} // namespace btas
+
 #include <btas/TensorBlas.hpp>
 
 #ifndef __BTAS_BLOCK_SPARSE_TENSOR_HPP
@@ -18,10 +33,113 @@
 
 namespace btas {
 
-// BLAS lv.3 : gemm
+namespace detail {
 
-/// Only for BlockSpTensor
-template<typename Scalar, typename Tp, size_t L, size_t M, size_t N, class Q, CBLAS_ORDER Order> struct Sp_gemm_impl;
+/// Local gemm task to compute block c[ij], which is sorted by approximate FLOPS count for load-balancing
+struct Sp_gemm_task_ {
+
+  /// ordinal index of c
+  size_t ij;
+
+  /// approximate FLOPS count
+  size_t flops;
+
+  /// block pairs of a and b held by ordinal indices, since cache_ may be reallocated during communication
+  std::vector<std::pair<size_t,size_t>> pairs;
+
+  Sp_gemm_task_ (size_t ij_ = 0) : ij(ij_), flops(0) { }
+
+  bool operator< (const Sp_gemm_task_& x) const { return flops < x.flops; }
+
+  bool operator> (const Sp_gemm_task_& x) const { return flops > x.flops; }
+};
+
+/// Collect block gemm tasks and execute them locally
+/// Transposition of a and b is resolved by ordinal strides over the block index space,
+/// so that a contraction over leading indices costs the same as the NoTrans case.
+/// \param arows number of row blocks of op(a) (= row blocks of c)
+/// \param acols number of contracted blocks (= row blocks of op(b))
+/// \param bcols number of col blocks of op(b) (= col blocks of c)
+template<typename Scalar, class TensorA, class TensorB, class TensorC>
+void Sp_gemm_blocks_ (
+  const CBLAS_TRANSPOSE& transa,
+  const CBLAS_TRANSPOSE& transb,
+  const Scalar& alpha,
+  const TensorA& a,
+  const TensorB& b,
+        TensorC& c,
+  size_t arows,
+  size_t acols,
+  size_t bcols)
+{
+  const Scalar one = static_cast<Scalar>(1);
+
+  // Strides of block ordinals of a and b (row-major) w.r.t. row and col indices of op(a) and op(b)
+  const size_t aRowStr = (transa == CblasNoTrans) ? acols : 1;
+  const size_t aColStr = (transa == CblasNoTrans) ? 1 : arows;
+  const size_t bRowStr = (transb == CblasNoTrans) ? bcols : 1;
+  const size_t bColStr = (transb == CblasNoTrans) ? 1 : acols;
+
+  std::vector<Sp_gemm_task_> local_tasks; local_tasks.reserve(c.nnz_local());
+
+  // c = op(a)*op(b)
+  for(size_t i = 0; i < arows; ++i) {
+    for(size_t j = 0; j < bcols; ++j) {
+      size_t ij = i*bcols+j;
+      if(!c.has(ij)) continue;
+      size_t me = c.where(ij);
+      Sp_gemm_task_ gemm_task(ij);
+      for(size_t k = 0; k < acols; ++k) {
+        size_t ik = i*aRowStr+k*aColStr;
+        size_t kj = k*bRowStr+j*bColStr;
+        if(a.has(ik) && b.has(kj)) {
+          // Sending objects to be required first, not calling dense gemm here.
+          // Objects on the same node are read from shared-memory window w/o messaging.
+          if(!a.is_shm_mapped(ik,me)) a.get(ik,me);
+          if(!b.is_shm_mapped(kj,me)) b.get(kj,me);
+          if(c.is_local(ij))
+            gemm_task.pairs.push_back(std::make_pair(ik,kj));
+        }
+      }
+      if(gemm_task.pairs.size() > 0) {
+        // FLOPS of block gemm is given by sqrt(|a|*|b|*|c|)
+        typename TensorC::block_type::extent_type cExts = c.block_extent(ij);
+        double cSize = std::accumulate(cExts.begin(),cExts.end(),1.0,std::multiplies<double>());
+        for(size_t k = 0; k < gemm_task.pairs.size(); ++k) {
+          typename TensorA::block_type::extent_type aExts = a.block_extent(gemm_task.pairs[k].first);
+          typename TensorB::block_type::extent_type bExts = b.block_extent(gemm_task.pairs[k].second);
+          double aSize = std::accumulate(aExts.begin(),aExts.end(),1.0,std::multiplies<double>());
+          double bSize = std::accumulate(bExts.begin(),bExts.end(),1.0,std::multiplies<double>());
+          gemm_task.flops += static_cast<size_t>(std::sqrt(aSize*bSize*cSize));
+        }
+        local_tasks.push_back(gemm_task);
+      }
+    }
+  }
+
+  // Calling gemm locally with SMP parallelism
+  // Since each task writes distinct c[ij], tasks run concurrently w/o locking.
+  std::sort(local_tasks.begin(),local_tasks.end(),std::greater<Sp_gemm_task_>());
+
+  size_t n = local_tasks.size();
+#pragma omp parallel for schedule(guided)
+  for(size_t m = 0; m < n; ++m) {
+    const Sp_gemm_task_& task = local_tasks[m];
+    typename TensorA::const_wrapper_type aik;
+    typename TensorB::const_wrapper_type bkj;
+    for(size_t k = 0; k < task.pairs.size(); ++k) {
+      a.get_view(task.pairs[k].first, aik);
+      b.get_view(task.pairs[k].second,bkj);
+      gemm(transa,transb,alpha,aik,bkj,one,c[task.ij]);
+    }
+  }
+  a.cache_clear();
+  b.cache_clear();
+}
+
+} // namespace detail
+
+// BLAS lv.3 : gemm
 
 template<typename Scalar, typename Tp, size_t L, size_t M, size_t N, class Q>
 struct Sp_gemm_impl<Scalar,Tp,L,M,N,Q,CblasRowMajor> {
@@ -61,14 +179,16 @@ struct Sp_gemm_impl<Scalar,Tp,L,M,N,Q,CblasRowMajor> {
     size_t brows = std::accumulate(b.extent().begin()+iBsta,b.extent().begin()+iBsta+  K,1ul,std::multiplies<size_t>());
     size_t bcols = std::accumulate(b.extent().begin()+jBsta,b.extent().begin()+jBsta+M-K,1ul,std::multiplies<size_t>());
 
+    BTAS_ASSERT(acols == brows,"Sp_gemm_impl::compute(...) failed by inconsistent contraction extent.");
+
     // Check qnum's for contraction
     if((transa == CblasConjTrans) ^ (transb == CblasConjTrans)) {
       for(size_t i = 0; i < K; ++i)
-        BTAS_ASSERT(is_equal(a.qnum_array(i+jAsta),b.qnum_array(i+jBsta)),"Sp_gemm_impl::compute(...) failed by qnum's of A*B.");
+        BTAS_ASSERT(is_equal(a.qnum_array(i+jAsta),b.qnum_array(i+iBsta)),"Sp_gemm_impl::compute(...) failed by qnum's of A*B.");
     }
     else {
       for(size_t i = 0; i < K; ++i)
-        BTAS_ASSERT(is_conj_equal(a.qnum_array(i+jAsta),b.qnum_array(i+jBsta)),"Sp_gemm_impl::compute(...) failed by qnum's of A*B.");
+        BTAS_ASSERT(is_conj_equal(a.qnum_array(i+jAsta),b.qnum_array(i+iBsta)),"Sp_gemm_impl::compute(...) failed by qnum's of A*B.");
     }
     // Get qnum_shape and size_shape of 'c'
     typename BlockSpTensor<Tp,N,Q,CblasRowMajor>::qnum_type cq;
@@ -109,70 +229,51 @@ struct Sp_gemm_impl<Scalar,Tp,L,M,N,Q,CblasRowMajor> {
       c.fill(static_cast<Scalar>(0));
     }
 
-    const Scalar one = static_cast<Scalar>(1);
-
-    typedef typename BlockSpTensor<Tp,L,Q,CblasRowMajor>::block_type block_type_a;
-    typedef typename BlockSpTensor<Tp,M,Q,CblasRowMajor>::block_type block_type_b;
-
-    typedef std::vector<std::pair<typename block_type_a::const_iterator,typename block_type_b::const_iterator>> task_type;
-
-    std::vector<std::pair<size_t,task_type>> local_tasks; local_tasks.reserve(c.nnz_local());
-
-    // c = NoTrans(a)*NoTrans(b)
-    if(transa == CblasNoTrans && transb == CblasNoTrans) {
-      for(size_t i = 0; i < arows; ++i) {
-        for(size_t j = 0; j < bcols; ++j) {
-          size_t ij = i*bcols+j;
-          if(!c.has(ij)) continue;
-          size_t me = c.where(ij);
-          task_type gemm_task;
-          for(size_t k = 0; k < acols; ++k) {
-            size_t ik = i*acols+k;
-            size_t kj = k*bcols+j;
-            if(a.has(ik) && b.has(kj)) {
-              // Sending objects to be required first, not calling dense gemm here.
-              auto aik = a.get(ik,me);
-              auto bkj = b.get(kj,me);
-              if(c.is_local(ij))
-                gemm_task.push_back(std::make_pair(aik,bkj));
-            }
-          }
-          if(gemm_task.size() > 0)
-            local_tasks.push_back(std::make_pair(ij,gemm_task));
-        }
-      }
-    }
-    // c = NoTrans(a)*Trans(b)
-
-    // c = Trans(a)*NoTrans(b)
-
-    // c = Trans(a)*Trans(b)
-
-    // Calling gemm locally
-    for(size_t m = 0; m < local_tasks.size(); ++m) {
-      const size_t& ij = local_tasks[m].first;
-      for(size_t k = 0; k < local_tasks[m].second.size(); ++k) {
-        auto& aik = local_tasks[m].second[k].first;
-        auto& bkj = local_tasks[m].second[k].second;
-        gemm(transa,transb,alpha,*aik,*bkj,one,c[ij]);
-      }
-    }
-    a.cache_clear();
-    b.cache_clear();
+    detail::Sp_gemm_blocks_(transa,transb,alpha,a,b,c,arows,acols,bcols);
   }
 };
 
-template<typename Scalar, typename Tp, size_t L, size_t M, size_t N, CBLAS_ORDER Order>
-struct Sp_gemm_impl<Scalar,Tp,L,M,N,NoSymmetry_,Order> {
+template<typename Scalar, typename Tp, size_t L, size_t M, size_t N>
+struct Sp_gemm_impl<Scalar,Tp,L,M,N,NoSymmetry_,CblasRowMajor> {
   static void compute (
     const CBLAS_TRANSPOSE& transa,
     const CBLAS_TRANSPOSE& transb,
     const Scalar& alpha,
-    const BlockSpTensor<Tp,L,NoSymmetry_,Order>& a,
-    const BlockSpTensor<Tp,M,NoSymmetry_,Order>& b,
+    const BlockSpTensor<Tp,L,NoSymmetry_,CblasRowMajor>& a,
+    const BlockSpTensor<Tp,M,NoSymmetry_,CblasRowMajor>& b,
     const Scalar& beta,
-          BlockSpTensor<Tp,N,NoSymmetry_,Order>& c)
-  { BTAS_ASSERT(false,"hasn't yet been implemented."); }
+          BlockSpTensor<Tp,N,NoSymmetry_,CblasRowMajor>& c)
+  {
+    const size_t K = (L+M-N)/2;
+
+    size_t iAsta = (transa == CblasNoTrans) ? 0 : K;
+    size_t jAsta = (transa == CblasNoTrans) ? L-K : 0;
+    size_t iBsta = (transb == CblasNoTrans) ? 0 : M-K;
+    size_t jBsta = (transb == CblasNoTrans) ? K : 0;
+
+    size_t arows = std::accumulate(a.extent().begin()+iAsta,a.extent().begin()+iAsta+L-K,1ul,std::multiplies<size_t>());
+    size_t acols = std::accumulate(a.extent().begin()+jAsta,a.extent().begin()+jAsta+  K,1ul,std::multiplies<size_t>());
+    size_t brows = std::accumulate(b.extent().begin()+iBsta,b.extent().begin()+iBsta+  K,1ul,std::multiplies<size_t>());
+    size_t bcols = std::accumulate(b.extent().begin()+jBsta,b.extent().begin()+jBsta+M-K,1ul,std::multiplies<size_t>());
+
+    BTAS_ASSERT(acols == brows,"Sp_gemm_impl::compute(...) failed by inconsistent contraction extent.");
+
+    // Check block sizes for contraction
+    for(size_t i = 0; i < K; ++i)
+      BTAS_ASSERT(a.size_array(i+jAsta) == b.size_array(i+iBsta),"Sp_gemm_impl::compute(...) failed by block sizes of A*B.");
+
+    // Sparsity of 'c' cannot be deduced w/o quantum numbers, it must be given by user
+    BTAS_ASSERT(!c.empty(),"Sp_gemm_impl::compute(...) requires sparsity of C to be given for NoSymmetry_.");
+    for(size_t i = 0; i < L-K; ++i)
+      BTAS_ASSERT(c.size_array(i)     == a.size_array(i+iAsta),"Sp_gemm_impl::compute(...) failed by block sizes of C.");
+    for(size_t i = 0; i < M-K; ++i)
+      BTAS_ASSERT(c.size_array(i+L-K) == b.size_array(i+jBsta),"Sp_gemm_impl::compute(...) failed by block sizes of C.");
+
+    // Scale by beta
+    scal(beta,c);
+
+    detail::Sp_gemm_blocks_(transa,transb,alpha,a,b,c,arows,acols,bcols);
+  }
 };
 
 } // namespace btas
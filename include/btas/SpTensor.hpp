@@ -13,6 +13,7 @@
 #include <btas/make_array.hpp>
 #include <btas/qnum_array_utils.hpp>
 #include <btas/SpShape.hpp>
+#include <btas/Sp/Sp_comm_impl.hpp>
 
 #define __HAS_NO_DATA__ 0x80000000
 
@@ -344,7 +345,7 @@ public:
 #ifndef _SERIAL
     if(this->is_local(i)) {
       // send from me
-      boost::mpi::broadcast(world_,store_[lcmap_[i]],this->where(i));
+      Sp_comm_impl<T>::broadcast(world_,const_cast<T&>(store_[lcmap_[i]]),this->where(i));
       it = const_iterator(store_.data()+lcmap_[i]);
     }
     else {
@@ -354,7 +355,7 @@ public:
         cache_.push_back(T());
       }
       // recv to me
-      boost::mpi::broadcast(world_,cache_[lcmap_[i]],this->where(i));
+      Sp_comm_impl<T>::broadcast(world_,cache_[lcmap_[i]],this->where(i));
       it = const_iterator(cache_.data()+lcmap_[i]);
     }
 #else
@@ -384,7 +385,7 @@ public:
         // ask whether communication needs
         int flag; world_.recv(to_,to_,flag);
         // send data -> to_
-        if(flag) world_.send(to_,i,*it);
+        if(flag) Sp_comm_impl<T>::send(world_,to_,i,*it);
         // return end() since my rank != to_
         it = store_.end();
       }
@@ -400,7 +401,7 @@ public:
           lcmap_[i] = cache_.size();
           cache_.push_back(T());
           // recv data
-          world_.recv(this->where(i),i,cache_[lcmap_[i]]);
+          Sp_comm_impl<T>::recv(world_,this->where(i),i,cache_[lcmap_[i]]);
         }
         else {
           // found in cache_, tell no communication needs
@@ -425,6 +426,21 @@ public:
   const_iterator get (const index_type& idx_, size_t to_) const
   { return this->get(shape_.ordinal(idx_),to_); }
 
+  /// search obj. from local storage or cache_ received by get(...), w/o communication
+  const_iterator find_cache (size_t i) const
+  {
+#ifndef _SERIAL
+    if(!this->has(i) || lcmap_[i] == __HAS_NO_DATA__) return store_.end();
+
+    if(this->is_local(i))
+      return const_iterator(store_.data()+lcmap_[i]);
+    else
+      return const_iterator(cache_.data()+lcmap_[i]);
+#else
+    return this->find(i);
+#endif
+  }
+
   // ****************************************************************************************************
   // others
 
@@ -3,6 +3,8 @@
 
 #include <btas/SpTensor.hpp>
 #include <btas/Sp/Sp_dotc_impl.hpp>
+#include <btas/Sp/Sp_scal_impl.hpp>
+#include <btas/Sp/Sp_gemm_impl.hpp>
 
 namespace btas {
 
@@ -20,6 +22,13 @@ dotc (
   const SpTensor<Tp,N,Q,Order>& y)
 { return Sp_dotc_impl<Tp,N,Q,Order>::compute(x,y); }
 
+/// BLAS lv.1 : scal
+template<typename Tp, size_t N, class Q, CBLAS_ORDER Order>
+void scal (
+  const typename Sp_scal_exec<Tp>::scalar_type& alpha,
+        SpTensor<Tp,N,Q,Order>& x)
+{ Sp_scal_impl<Tp,N,Q,Order>::compute(alpha,x); }
+
 /// BLAS lv.3 : gemm (BlockSpTensor only)
 template<typename Scalar, typename Tp, size_t L, size_t M, size_t N, class Q, CBLAS_ORDER Order>
 void gemm (
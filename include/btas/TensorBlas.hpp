@@ -14,6 +14,8 @@
 #include <btas/Tensor.hpp>
 #endif
 
+#include <btas/TensorWrapper.hpp>
+
 namespace btas {
 
 //  ====================================================================================================
@@ -50,7 +52,7 @@ struct copy_helper_<T,N,N,Order> {
 /// if kept_ == true, a reshaped copy is enabled
 /// where y must be allocated, and may have different extent but have the same data size
 template<typename T, size_t M, size_t N, CBLAS_ORDER Order>
-void copy (const Tensor<T,N,Order>& x, Tensor<T,N,Order>& y, bool kept_ = false)
+void copy (const Tensor<T,M,Order>& x, Tensor<T,N,Order>& y, bool kept_ = false)
 {
   copy_helper_<T,M,N,Order>::call(x,y,kept_);
 }
@@ -203,14 +205,14 @@ void ger (
 //
 //  ====================================================================================================
 
-/// gemm
+/// gemm for tensor views, e.g. wrapping blocks mapped on shared-memory
 template<typename T, size_t L, size_t M, size_t N, CBLAS_ORDER Order>
 void gemm (
   const CBLAS_TRANSPOSE& transa,
   const CBLAS_TRANSPOSE& transb,
   const T& alpha,
-  const Tensor<T,L,Order>& a,
-  const Tensor<T,M,Order>& b,
+  const TensorWrapper<const T*,L,Order>& a,
+  const TensorWrapper<const T*,M,Order>& b,
   const T& beta,
         Tensor<T,N,Order>& c)
 {
@@ -253,6 +255,22 @@ void gemm (
   gemm(Order,transa,transb,cRows,cCols,kExts,alpha,a.data(),lda,b.data(),ldb,beta,c.data(),ldc);
 }
 
+/// gemm
+template<typename T, size_t L, size_t M, size_t N, CBLAS_ORDER Order>
+void gemm (
+  const CBLAS_TRANSPOSE& transa,
+  const CBLAS_TRANSPOSE& transb,
+  const T& alpha,
+  const Tensor<T,L,Order>& a,
+  const Tensor<T,M,Order>& b,
+  const T& beta,
+        Tensor<T,N,Order>& c)
+{
+  TensorWrapper<const T*,L,Order> aw(a);
+  TensorWrapper<const T*,M,Order> bw(b);
+  gemm(transa,transb,alpha,aw,bw,beta,c);
+}
+
 //  ====================================================================================================
 //
 //  NON-BLAS
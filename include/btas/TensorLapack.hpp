@@ -18,13 +18,17 @@ namespace btas {
 /// Solve real-symmetric eigenvalue problem (SEP)
 /// Def.: A({i,j,k},{i,j,k}) = Z({i,j,k,e}) * w({e}) * Z^T({e,i,j,k})
 /// NOTE: if called with complex array, gives an error
+/// \param nev if > 0, only nev lowest eigenpairs are computed
+/// \param driver LAPACK driver, selected by lapack_driver_policy by default
 template<typename T, size_t N, CBLAS_ORDER Order>
 void syev (
   const char& jobz,
   const char& uplo,
   const Tensor<T,2*N-2,Order>& a,
         Tensor<T,1,Order>& w,
-        Tensor<T,N,Order>& z)
+        Tensor<T,N,Order>& z,
+  const size_t& nev = 0,
+  const BTAS_EIG_DRIVER& driver = EigAuto)
 {
   const size_t K = N-1;
 
@@ -32,28 +36,44 @@ void syev (
 
   size_t aCols = std::accumulate(a.extent().begin()+K,a.extent().end(),1ul,std::multiplies<size_t>());
 
+  size_t nW = (nev > 0 && nev < aCols) ? nev : aCols;
+
   typename Tensor<T,N,Order>::extent_type zExtent;
   for(size_t i = 0; i < K; ++i) zExtent[i] = a.extent(i);
-  zExtent[N-1] = aCols;
+  zExtent[N-1] = nW;
+
+  w.resize(nW);
+
+  if(nW == aCols) {
+    z.resize(zExtent);
+    copy(a,z); // reshape a and copy to z
 
-  z.resize(zExtent);
-  copy(a,z); // reshape a and copy to z
+    syev(driver,Order,jobz,uplo,aCols,z.data(),aCols,w.data(),nW,z.data(),aCols);
+  }
+  else {
+    Tensor<T,2*N-2,Order> aCp(a);
 
-  w.resize(aCols);
+    z.resize(zExtent);
+    size_t ldz = (Order == CblasRowMajor) ? nW : aCols;
 
-  syev(Order,jobz,uplo,aCols,z.data(),aCols,w.data());
+    syev(driver,Order,jobz,uplo,aCols,aCp.data(),aCols,w.data(),nW,z.data(),ldz);
+  }
 }
 
 /// Solve hermitian eigenvalue problem (HEP)
 /// Def.: A({i,j,k},{i,j,k}) = Z({i,j,k,e}) * w({e}) * Z^T({e,i,j,k})
 /// NOTE: if called with real array, redirect to Syev
+/// \param nev if > 0, only nev lowest eigenpairs are computed
+/// \param driver LAPACK driver, selected by lapack_driver_policy by default
 template<typename T, size_t N, CBLAS_ORDER Order>
 void heev (
   const char& jobz,
   const char& uplo,
   const Tensor<T,2*N-2,Order>& a,
         Tensor<typename remove_complex<T>::type,1,Order>& w,
-        Tensor<T,N,Order>& z)
+        Tensor<T,N,Order>& z,
+  const size_t& nev = 0,
+  const BTAS_EIG_DRIVER& driver = EigAuto)
 {
   const size_t K = N-1;
 
@@ -61,18 +81,31 @@ void heev (
 
   size_t aCols = std::accumulate(a.extent().begin()+K,a.extent().end(),1ul,std::multiplies<size_t>());
 
+  size_t nW = (nev > 0 && nev < aCols) ? nev : aCols;
+
   typename Tensor<T,N,Order>::extent_type zExtent;
   for(size_t i = 0; i < K; ++i) zExtent[i] = a.extent(i);
-  zExtent[N-1] = aCols;
+  zExtent[N-1] = nW;
+
+  w.resize(nW);
+
+  if(nW == aCols) {
+    z.resize(zExtent); copy(a,z); // reshape a and copy to z
 
-  z.resize(zExtent); copy(a,z); // reshape a and copy to z
+    heev(driver,Order,jobz,uplo,aCols,z.data(),aCols,w.data(),nW,z.data(),aCols);
+  }
+  else {
+    Tensor<T,2*N-2,Order> aCp(a);
 
-  w.resize(aCols);
+    z.resize(zExtent);
+    size_t ldz = (Order == CblasRowMajor) ? nW : aCols;
 
-  heev(Order,jobz,uplo,aCols,z.data(),aCols,w.data());
+    heev(driver,Order,jobz,uplo,aCols,aCp.data(),aCols,w.data(),nW,z.data(),ldz);
+  }
 }
 
 /// Solve singular value decomposition (SVD)
+/// \param driver LAPACK driver, selected by lapack_driver_policy by default
 template<typename T, size_t M, size_t N, CBLAS_ORDER Order>
 void gesvd (
   const char& jobu,
@@ -80,7 +113,8 @@ void gesvd (
   const Tensor<T,M+N-2,Order>& a,
         Tensor<typename remove_complex<T>::type,1,Order>& s,
         Tensor<T,M,Order>& u,
-        Tensor<T,N,Order>& vt)
+        Tensor<T,N,Order>& vt,
+  const BTAS_SVD_DRIVER& driver = SvdAuto)
 {
   size_t aRows = std::accumulate(a.extent().begin(),a.extent().begin()+M-1,1ul,std::multiplies<size_t>());
   size_t aCols = std::accumulate(a.extent().begin()+M-1,a.extent().end(),  1ul,std::multiplies<size_t>());
@@ -89,7 +123,7 @@ void gesvd (
   size_t sExts = std::min(aRows,aCols);
 
   size_t uCols = (jobu == 'A' || jobu == 'a') ? aRows : sExts;
-  size_t ldu = (Order == CblasRowMajor) ? aRows : uCols;
+  size_t ldu = (Order == CblasRowMajor) ? uCols : aRows;
 
   size_t vtRows = (jobvt == 'A' || jobvt == 'a') ? aCols : sExts;
   size_t ldvt = (Order == CblasRowMajor) ? aCols : vtRows;
@@ -104,13 +138,13 @@ void gesvd (
 
   s.resize(sExts);
 
-  BTAS_ASSERT((jobu == 'O' || jobu == 'o' || jobvt == 'O' || jobvt == 'o'), "job* = 'O' is currently disabled.")
+  BTAS_ASSERT(!(jobu == 'O' || jobu == 'o' || jobvt == 'O' || jobvt == 'o'), "job* = 'O' is currently disabled.")
 
   if(jobu  != 'N' && jobu  != 'n') u.resize(uExtent);
   if(jobvt != 'N' && jobvt != 'n') vt.resize(vtExtent);
 
   Tensor<T,M+N-2,Order> aCp(a);
-  gesvd(Order,jobu,jobvt,aRows,aCols,aCp.data(),lda,s.data(),u.data(),ldu,vt.data(),ldvt);
+  gesvd(driver,Order,jobu,jobvt,aRows,aCols,aCp.data(),lda,s.data(),u.data(),ldu,vt.data(),ldvt);
 }
 
 /// perform a QR decomposition : a = q * r
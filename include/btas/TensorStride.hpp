@@ -4,8 +4,13 @@
 #include <algorithm>
 
 #include <boost/array.hpp>
+#include <boost/version.hpp>
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/array.hpp>
+// serialization of boost::array was moved out of array.hpp since Boost 1.64
+#if BOOST_VERSION >= 106400
+#include <boost/serialization/boost_array.hpp>
+#endif
 
 namespace btas {
 
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include <boost/random.hpp>
+
+// only BLAS/LAPACK wrappers are needed, s.t. this can be built w/o Tensor classes
+#include <blas/wrappers.h>
+#include <lapack/wrappers.h>
+
+using namespace btas;
+
+/// max. abs. difference of A and U*diag(S)*VT, and orthogonality of U and VT (row-major, thin)
+double check_svd (
+  const size_t& M, const size_t& N,
+  const double* A, const double* S, const double* U, const double* VT)
+{
+  const size_t K = std::min(M,N);
+  double err = 0.0;
+  for(size_t i = 0; i < M; ++i)
+    for(size_t j = 0; j < N; ++j) {
+      double x = 0.0;
+      for(size_t k = 0; k < K; ++k) x += U[i*K+k]*S[k]*VT[k*N+j];
+      err = std::max(err,std::fabs(x-A[i*N+j]));
+    }
+  for(size_t p = 0; p < K; ++p)
+    for(size_t q = 0; q < K; ++q) {
+      double x = 0.0, y = 0.0;
+      for(size_t i = 0; i < M; ++i) x += U[i*K+p]*U[i*K+q];
+      for(size_t j = 0; j < N; ++j) y += VT[p*N+j]*VT[q*N+j];
+      err = std::max(err,std::fabs(x-((p == q) ? 1.0 : 0.0)));
+      err = std::max(err,std::fabs(y-((p == q) ? 1.0 : 0.0)));
+    }
+  return err;
+}
+
+/// random M x N matrix with singular values 10^(-decay*k/K)
+void random_matrix (boost::mt19937& rGen, const size_t& M, const size_t& N, const double& decay, std::vector<double>& A)
+{
+  boost::random::uniform_real_distribution<double> dist(-1.0,1.0);
+  const size_t K = std::min(M,N);
+  // orthonormal factors by QR of random matrices
+  std::vector<double> X(M*K), Y(K*N);
+  for(size_t i = 0; i < X.size(); ++i) X[i] = dist(rGen);
+  for(size_t i = 0; i < Y.size(); ++i) Y[i] = dist(rGen);
+  std::vector<double> tau(K);
+  geqrf(CblasRowMajor,M,K,X.data(),K,tau.data());
+  orgqr(CblasRowMajor,M,K,K,X.data(),K,tau.data());
+  gelqf(CblasRowMajor,K,N,Y.data(),N,tau.data());
+  orglq(CblasRowMajor,K,N,K,Y.data(),N,tau.data());
+  A.assign(M*N,0.0);
+  for(size_t k = 0; k < K; ++k) {
+    double s = std::pow(10.0,-decay*k/K);
+    for(size_t i = 0; i < M; ++i)
+      for(size_t j = 0; j < N; ++j) A[i*N+j] += X[i*K+k]*s*Y[k*N+j];
+  }
+}
+
+int main ()
+{
+  boost::mt19937 rGen;
+
+  int nFail = 0;
+
+  std::cout.setf(std::ios::scientific,std::ios::floatfield);
+  std::cout.precision(2);
+
+  // accuracy and timing for tall-skinny (d*M x M) and short-wide (M x d*M) matrices
+  std::cout << "Gram matrix SVD vs. gesvd :: " << std::endl;
+  for(size_t M : { 32, 64, 128, 256 })
+  for(size_t d : { 4, 16 })
+  for(int wide = 0; wide < 2; ++wide) {
+    const size_t rows = wide ? M : d*M;
+    const size_t cols = wide ? d*M : M;
+    const size_t K = M;
+
+    std::vector<double> A;
+    random_matrix(rGen,rows,cols,3.0,A); // s_min / s_max = 1.0e-3
+
+    std::vector<double> a(A), s(K), u(rows*K), vt(K*cols);
+    std::vector<double> sRef(K), uRef(rows*K), vtRef(K*cols);
+
+    const int nRepeat = 3;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for(int r = 0; r < nRepeat; ++r) {
+      a = A;
+      gesvd(SvdGesvd,CblasRowMajor,'S','S',rows,cols,a.data(),cols,sRef.data(),uRef.data(),K,vtRef.data(),cols);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    bool used = true;
+    for(int r = 0; r < nRepeat; ++r)
+      used &= gesvd_gram(CblasRowMajor,'S','S',rows,cols,A.data(),cols,s.data(),u.data(),K,vt.data(),cols,0.0);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double tRef  = std::chrono::duration<double>(t1-t0).count()/nRepeat;
+    double tGram = std::chrono::duration<double>(t2-t1).count()/nRepeat;
+
+    double sErr = 0.0;
+    for(size_t k = 0; k < K; ++k) sErr = std::max(sErr,std::fabs(s[k]-sRef[k])/sRef[k]);
+    double rErr = check_svd(rows,cols,A.data(),s.data(),u.data(),vt.data());
+
+    bool fail = !used || sErr > 1.0e-8 || rErr > 1.0e-8;
+    std::cout << "\t" << std::setw(5) << rows << " x " << std::setw(5) << cols
+              << " gesvd " << tRef << " sec. gram " << tGram << " sec. (x" << std::fixed << std::setprecision(1) << tRef/tGram << ")"
+              << std::scientific << std::setprecision(2) << " |dS/S| = " << sErr << " |A-USV| = " << rErr << (fail ? " FAIL" : "") << std::endl;
+    if(fail) ++nFail;
+  }
+
+  // fallback for ill-conditioned matrix : dispatcher must give the same accuracy as gesvd
+  std::cout << "Fallback for ill-conditioned matrix :: " << std::endl;
+  {
+    const size_t rows = 512, cols = 64, K = cols;
+    std::vector<double> A;
+    random_matrix(rGen,rows,cols,12.0,A); // s_min / s_max = 1.0e-12
+    std::vector<double> s(K), u(rows*K), vt(K*cols);
+    bool used = gesvd_gram(CblasRowMajor,'S','S',rows,cols,A.data(),cols,s.data(),u.data(),K,vt.data(),cols,lapack_driver_policy::gram_svd_tolerance());
+    std::vector<double> a(A);
+    gesvd(SvdGram,CblasRowMajor,'S','S',rows,cols,a.data(),cols,s.data(),u.data(),K,vt.data(),cols);
+    double rErr = check_svd(rows,cols,A.data(),s.data(),u.data(),vt.data());
+    bool fail = used || rErr > 1.0e-12;
+    std::cout << "\t" << rows << " x " << cols << " rejected = " << (used ? "no" : "yes") << " |A-USV| = " << rErr << (fail ? " FAIL" : "") << std::endl;
+    if(fail) ++nFail;
+  }
+
+  if(nFail == 0)
+    std::cout << "PASS" << std::endl;
+  else
+    std::cout << "FAIL: " << nFail << " cases" << std::endl;
+
+  return nFail;
+}
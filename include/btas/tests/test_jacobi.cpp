@@ -0,0 +1,183 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <boost/random.hpp>
+
+// only BLAS/LAPACK wrappers are needed, s.t. this can be built w/o Tensor classes
+#include <blas/wrappers.h>
+#include <lapack/wrappers.h>
+
+using namespace btas;
+
+/// max. abs. difference of A and U*diag(S)*VT, and orthogonality of U and VT
+double check_svd (
+  const int& order, const size_t& M, const size_t& N, const size_t& nu, const size_t& nv,
+  const double* A, const double* S, const double* U, const double* VT)
+{
+  const size_t K = std::min(M,N);
+  const size_t ldA = (order == LAPACK_ROW_MAJOR) ? N : M;
+  const size_t ldU = (order == LAPACK_ROW_MAJOR) ? nu : M;
+  const size_t ldV = (order == LAPACK_ROW_MAJOR) ? N : nv;
+  #define __A(i,j) ((order == LAPACK_ROW_MAJOR) ? A [(i)*ldA+(j)] : A [(i)+(j)*ldA])
+  #define __U(i,j) ((order == LAPACK_ROW_MAJOR) ? U [(i)*ldU+(j)] : U [(i)+(j)*ldU])
+  #define __V(i,j) ((order == LAPACK_ROW_MAJOR) ? VT[(i)*ldV+(j)] : VT[(i)+(j)*ldV])
+  double err = 0.0;
+  for(size_t i = 0; i < M; ++i)
+    for(size_t j = 0; j < N; ++j) {
+      double x = 0.0;
+      for(size_t k = 0; k < K; ++k) x += __U(i,k)*S[k]*__V(k,j);
+      err = std::max(err,std::fabs(x-__A(i,j)));
+    }
+  for(size_t p = 0; p < nu; ++p)
+    for(size_t q = 0; q < nu; ++q) {
+      double x = 0.0;
+      for(size_t i = 0; i < M; ++i) x += __U(i,p)*__U(i,q);
+      err = std::max(err,std::fabs(x-((p == q) ? 1.0 : 0.0)));
+    }
+  for(size_t p = 0; p < nv; ++p)
+    for(size_t q = 0; q < nv; ++q) {
+      double x = 0.0;
+      for(size_t j = 0; j < N; ++j) x += __V(p,j)*__V(q,j);
+      err = std::max(err,std::fabs(x-((p == q) ? 1.0 : 0.0)));
+    }
+  #undef __A
+  #undef __U
+  #undef __V
+  return err;
+}
+
+/// fill x by uniform random numbers in [-1,1), rGen is advanced
+void random_fill (boost::mt19937& rGen, std::vector<double>& x)
+{
+  boost::random::uniform_real_distribution<double> dist(-1.0,1.0);
+  for(size_t i = 0; i < x.size(); ++i) x[i] = dist(rGen);
+}
+
+int main ()
+{
+  boost::mt19937 rGen;
+
+  const double tol = 1.0e-12;
+
+  int nFail = 0;
+
+  std::cout.setf(std::ios::scientific,std::ios::floatfield);
+  std::cout.precision(2);
+
+  // SVD : compared with gesvd
+  std::cout << "SVD by one-sided Jacobi vs. gesvd :: " << std::endl;
+  for(int order : { LAPACK_ROW_MAJOR, LAPACK_COL_MAJOR })
+  for(char job : { 'S', 'A' })
+  for(size_t M = 1; M <= BTAS_JACOBI_NMAX; ++M)
+  for(size_t N = 1; N <= BTAS_JACOBI_NMAX; ++N)
+  for(int kind = 0; kind < 3; ++kind) { // 0: random, 1: rank-deficient, 2: zero
+    const size_t K  = std::min(M,N);
+    const size_t nu = (job == 'A') ? M : K;
+    const size_t nv = (job == 'A') ? N : K;
+
+    const size_t ldA = (order == LAPACK_ROW_MAJOR) ? N : M;
+    const size_t ldU = (order == LAPACK_ROW_MAJOR) ? nu : M;
+    const size_t ldV = (order == LAPACK_ROW_MAJOR) ? N : nv;
+
+    // A is stored in the given order
+    std::vector<double> A(M*N,0.0);
+    if(kind == 0) {
+      random_fill(rGen,A);
+    }
+    else if(kind == 1) {
+      // rank = K/2 as sum of outer products
+      for(size_t r = 0; r < K/2; ++r) {
+        std::vector<double> x(M); random_fill(rGen,x);
+        std::vector<double> y(N); random_fill(rGen,y);
+        for(size_t i = 0; i < M; ++i)
+          for(size_t j = 0; j < N; ++j) A[(order == LAPACK_ROW_MAJOR) ? i*ldA+j : i+j*ldA] += x[i]*y[j];
+      }
+    }
+
+    std::vector<double> aRef(A), aJac(A);
+    std::vector<double> sRef(K), sJac(K);
+    std::vector<double> uRef(M*nu), uJac(M*nu);
+    std::vector<double> vRef(nv*N), vJac(nv*N);
+
+    gesvd(SvdGesvd, order,job,job,M,N,aRef.data(),ldA,sRef.data(),uRef.data(),ldU,vRef.data(),ldV);
+    gesvd(SvdJacobi,order,job,job,M,N,aJac.data(),ldA,sJac.data(),uJac.data(),ldU,vJac.data(),ldV);
+
+    double sErr = 0.0;
+    for(size_t k = 0; k < K; ++k) sErr = std::max(sErr,std::fabs(sRef[k]-sJac[k]));
+    double rErr = check_svd(order,M,N,nu,nv,A.data(),sJac.data(),uJac.data(),vJac.data());
+
+    if(sErr > tol || rErr > tol) {
+      std::cout << "\tFAIL: " << ((order == LAPACK_ROW_MAJOR) ? "row" : "col") << " job = " << job
+                << " M = " << std::setw(2) << M << " N = " << std::setw(2) << N << " kind = " << kind
+                << " |dS| = " << sErr << " |A-USV| = " << rErr << std::endl;
+      ++nFail;
+    }
+  }
+
+  // eigenvalue problem : compared with syev
+  std::cout << "Eigensolver by cyclic Jacobi vs. syev :: " << std::endl;
+  for(int order : { LAPACK_ROW_MAJOR, LAPACK_COL_MAJOR })
+  for(char uplo : { 'U', 'L' })
+  for(size_t N = 1; N <= BTAS_JACOBI_NMAX; ++N)
+  for(int kind = 0; kind < 3; ++kind) { // 0: random, 1: degenerate, 2: zero
+    std::vector<double> H(N*N,0.0);
+    if(kind == 0) {
+      random_fill(rGen,H);
+      for(size_t i = 0; i < N; ++i)
+        for(size_t j = 0; j < i; ++j) H[i*N+j] = H[j*N+i];
+    }
+    else if(kind == 1) {
+      // projector onto random K/2 dimensional space
+      const size_t K = N/2+1;
+      std::vector<double> X(N*K);
+      random_fill(rGen,X);
+      for(size_t i = 0; i < N; ++i)
+        for(size_t j = 0; j < N; ++j)
+          for(size_t k = 0; k < K; ++k) H[i*N+j] += X[i*K+k]*X[j*K+k];
+    }
+
+    std::vector<double> zRef(H), zJac(H);
+    std::vector<double> wRef(N), wJac(N);
+
+    syev(EigSyev,  order,'V',uplo,N,zRef.data(),N,wRef.data(),0,zRef.data(),N);
+    syev(EigJacobi,order,'V',uplo,N,zJac.data(),N,wJac.data(),0,zJac.data(),N);
+
+    double wErr = 0.0;
+    for(size_t k = 0; k < N; ++k) wErr = std::max(wErr,std::fabs(wRef[k]-wJac[k]));
+
+    // residual |H z - w z| and orthogonality, H is symmetric so that the storage order does not matter
+    #define __Z(i,k) ((order == LAPACK_ROW_MAJOR) ? zJac[(i)*N+(k)] : zJac[(k)*N+(i)])
+    double rErr = 0.0;
+    for(size_t k = 0; k < N; ++k) {
+      for(size_t i = 0; i < N; ++i) {
+        double x = 0.0;
+        for(size_t j = 0; j < N; ++j) x += H[i*N+j]*__Z(j,k);
+        x -= wJac[k]*__Z(i,k);
+        rErr = std::max(rErr,std::fabs(x));
+      }
+      for(size_t l = 0; l < N; ++l) {
+        double x = 0.0;
+        for(size_t i = 0; i < N; ++i) x += __Z(i,k)*__Z(i,l);
+        rErr = std::max(rErr,std::fabs(x-((k == l) ? 1.0 : 0.0)));
+      }
+    }
+    #undef __Z
+
+    if(wErr > tol || rErr > tol) {
+      std::cout << "\tFAIL: " << ((order == LAPACK_ROW_MAJOR) ? "row" : "col") << " uplo = " << uplo
+                << " N = " << std::setw(2) << N << " kind = " << kind
+                << " |dW| = " << wErr << " |Hz-wz| = " << rErr << std::endl;
+      ++nFail;
+    }
+  }
+
+  if(nFail == 0)
+    std::cout << "PASS" << std::endl;
+  else
+    std::cout << "FAIL: " << nFail << " cases" << std::endl;
+
+  return nFail;
+}
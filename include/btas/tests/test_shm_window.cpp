@@ -0,0 +1,112 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <boost/mpi.hpp>
+
+#include <btas.h>
+#include <btas/BlockSpTensor.hpp>
+
+#include "fermion.h"
+
+using namespace btas;
+
+typedef BlockSpTensor<double,2,fermion> matrix_t;
+typedef matrix_t::qnum_array_type qarray_t;
+typedef matrix_t::size_array_type narray_t;
+
+/// value of element k of block i, which can be checked on any proc.
+inline double element (size_t i, size_t k) { return i+1.0e-3*k; }
+
+/// max. abs. difference of c and d over local blocks
+double local_diff (const matrix_t& c, const matrix_t& d)
+{
+  double err = 0.0;
+  for(size_t i = 0; i < c.size(); ++i) {
+    if(!c.is_local(i)) continue;
+    for(size_t k = 0; k < c[i].size(); ++k) err = std::max(err,std::fabs(c[i].data()[k]-d[i].data()[k]));
+  }
+  return err;
+}
+
+int main (int argc, char* argv[])
+{
+  boost::mpi::environment env(argc,argv);
+  boost::mpi::communicator world;
+
+  qarray_t qa;
+  qa.push_back(fermion(0, 0));
+  qa.push_back(fermion(1, 1));
+  qa.push_back(fermion(1,-1));
+  qa.push_back(fermion(2, 0));
+
+  narray_t na;
+  for(size_t i = 0; i < qa.size(); ++i) na.push_back(2+i);
+
+  matrix_t a(fermion(0,0),make_array(qa,conj(qa)),make_array(na,na));
+  for(size_t i = 0; i < a.size(); ++i) {
+    if(!a.is_local(i)) continue;
+    for(size_t k = 0; k < a[i].size(); ++k) a[i].data()[k] = element(i,k);
+  }
+
+  int nFail = 0;
+
+  // 1) every block can be read through the window from every proc. (all procs. are on the same node here)
+  a.shm_publish();
+  size_t nRemote = 0;
+  double err = 0.0;
+  bool mapped = true;
+  for(size_t i = 0; i < a.size(); ++i) {
+    if(!a.has(i)) continue;
+    mapped &= a.is_shm_mapped(i);
+    matrix_t::const_wrapper_type x;
+    if(!a.get_view(i,x)) { mapped = false; continue; }
+    if(!a.is_local(i)) ++nRemote;
+    for(size_t k = 0; k < x.size(); ++k) err = std::max(err,std::fabs(x.data()[k]-element(i,k)));
+  }
+  int fail = (!mapped || err > 0.0 || (world.size() > 1 && nRemote == 0));
+  fail = boost::mpi::all_reduce(world,fail,std::plus<int>());
+  if(world.rank() == 0)
+    std::cout << "\tget_view from window : " << (fail ? "FAIL" : "OK") << std::endl;
+  if(fail) ++nFail;
+
+  // 2) gemm reads mapped blocks w/o messaging, and gives the same result as w/o window
+  matrix_t c, d;
+  gemm(CblasNoTrans,CblasNoTrans,1.0,a,a,1.0,c);
+  matrix_t b(a); // copy is not mapped
+  gemm(CblasNoTrans,CblasNoTrans,1.0,b,b,1.0,d);
+  double cerr = boost::mpi::all_reduce(world,local_diff(c,d),boost::mpi::maximum<double>());
+  if(world.rank() == 0)
+    std::cout << "\tgemm with window : max|dC| = " << std::scientific << std::setprecision(2) << cerr << (cerr > 1.0e-14 ? " FAIL" : "") << std::endl;
+  if(cerr > 1.0e-14) ++nFail;
+
+  // 3) assignment only unmaps locally, then blocks are read by messaging until published again
+  a = b;
+  int still = 0;
+  for(size_t i = 0; i < a.size(); ++i) if(a.is_shm_mapped(i)) still = 1;
+  still = boost::mpi::all_reduce(world,still,std::plus<int>());
+  if(world.rank() == 0)
+    std::cout << "\tunmapped by assignment : " << (still ? "FAIL" : "OK") << std::endl;
+  if(still) ++nFail;
+
+  // 4) window is reused by the next publish, and freed collectively
+  a.shm_publish();
+  a.shm_release();
+  still = 0;
+  for(size_t i = 0; i < a.size(); ++i) if(a.is_shm_mapped(i)) still = 1;
+  still = boost::mpi::all_reduce(world,still,std::plus<int>());
+  if(world.rank() == 0)
+    std::cout << "\treleased : " << (still ? "FAIL" : "OK") << std::endl;
+  if(still) ++nFail;
+
+  if(world.rank() == 0) {
+    if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+    else
+      std::cout << "FAIL: " << nFail << " cases" << std::endl;
+  }
+
+  return nFail;
+}
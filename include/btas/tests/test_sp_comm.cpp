@@ -0,0 +1,124 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+#include <boost/mpi.hpp>
+
+#include <btas.h>
+
+using namespace btas;
+
+/// tensor with values which identify the sender
+template<typename T, size_t N>
+void make_tensor (const typename Tensor<T,N>::extent_type& exts, int seed, Tensor<T,N>& x)
+{
+  x.resize(exts);
+  for(size_t k = 0; k < x.size(); ++k) x.data()[k] = static_cast<T>(seed*1000.0+k);
+}
+
+template<typename T, size_t N>
+bool is_same (const Tensor<T,N>& x, const Tensor<T,N>& y)
+{ return x.extent() == y.extent() && std::equal(x.begin(),x.end(),y.begin()); }
+
+/// rank 0 sends x to rank 1, which sends it back, then x is broadcast from the last rank
+/// \return number of failures found on this proc.
+template<class Comm, typename T, size_t N>
+int round_trip (const boost::mpi::communicator& world, const typename Tensor<T,N>::extent_type& exts)
+{
+  int nFail = 0;
+  Tensor<T,N> x, y;
+  make_tensor(exts,1,x);
+  if(world.size() > 1) {
+    if(world.rank() == 0) {
+      Comm::send(world,1,0,x);
+      Comm::recv(world,1,1,y);
+      if(!is_same(x,y)) ++nFail;
+    }
+    if(world.rank() == 1) {
+      // receiving into non-empty tensor of different shape
+      make_tensor(exts,2,y);
+      y.resize(typename Tensor<T,N>::extent_type());
+      Comm::recv(world,0,0,y);
+      if(!is_same(x,y)) ++nFail;
+      Comm::send(world,0,1,y);
+    }
+  }
+  int root = world.size()-1;
+  Tensor<T,N> z;
+  if(world.rank() == root) z = x;
+  Comm::broadcast(world,z,root);
+  if(!is_same(x,z)) ++nFail;
+  return nFail;
+}
+
+/// wall time of one-way transfer of x from rank 0 to rank 1 (average of ping-pong)
+template<class Comm, typename T, size_t N>
+double transfer_time (const boost::mpi::communicator& world, const Tensor<T,N>& x, int nRepeat)
+{
+  Tensor<T,N> y;
+  world.barrier();
+  double t0 = MPI_Wtime();
+  for(int r = 0; r < nRepeat; ++r) {
+    if(world.rank() == 0) {
+      Comm::send(world,1,r,x);
+      Comm::recv(world,1,r,y);
+    }
+    if(world.rank() == 1) {
+      Comm::recv(world,0,r,y);
+      Comm::send(world,0,r,y);
+    }
+  }
+  return (MPI_Wtime()-t0)/(2*nRepeat);
+}
+
+int main (int argc, char* argv[])
+{
+  boost::mpi::environment env(argc,argv);
+  boost::mpi::communicator world;
+
+  typedef Tensor<double,2> dtensor_t;
+  typedef Tensor<float,3> stensor_t;
+
+  int nFail = 0;
+
+  // raw path for MPI datatypes, archive path forced by the 2nd template parameter
+  nFail += round_trip<Sp_comm_impl<dtensor_t>,double,2>(world,make_array<size_t>(3,5));
+  nFail += round_trip<Sp_comm_impl<dtensor_t,false>,double,2>(world,make_array<size_t>(3,5));
+  nFail += round_trip<Sp_comm_impl<stensor_t>,float,3>(world,make_array<size_t>(2,3,4));
+  nFail += round_trip<Sp_comm_impl<dtensor_t>,double,2>(world,make_array<size_t>(0,5));
+  nFail = boost::mpi::all_reduce(world,nFail,std::plus<int>());
+  // double block must take the raw path
+  if(!Sp_is_raw_block_<dtensor_t>::value) ++nFail;
+
+  if(world.rank() == 0) {
+    std::cout << "Sparse tensor element transfer :: " << std::endl;
+    std::cout << "\traw (double, float) and archive round trips : " << (nFail ? "FAIL" : "OK") << std::endl;
+  }
+
+  // timing of 1000 x 1000 double block
+  if(world.size() > 1) {
+    dtensor_t x;
+    make_tensor(make_array<size_t>(1000,1000),0,x);
+    double tRaw = transfer_time<Sp_comm_impl<dtensor_t>      >(world,x,10);
+    double tSer = transfer_time<Sp_comm_impl<dtensor_t,false> >(world,x,10);
+    if(world.rank() == 0) {
+      std::cout.setf(std::ios::fixed,std::ios::floatfield);
+      std::cout.precision(2);
+      std::cout << "\t1000 x 1000 double, one-way : archive " << tSer*1.0e3 << " ms raw " << tRaw*1.0e3 << " ms (x"
+                << std::setprecision(1) << tSer/tRaw << ")" << std::endl;
+    }
+  }
+  else if(world.rank() == 0) {
+    std::cout << "\tsend/recv and timing are skipped, since they need 2 procs. at least" << std::endl;
+  }
+
+  if(world.rank() == 0) {
+    if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+    else
+      std::cout << "FAIL" << std::endl;
+  }
+
+  return nFail;
+}
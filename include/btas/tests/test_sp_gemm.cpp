@@ -0,0 +1,205 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <boost/mpi.hpp>
+#include <boost/random.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <btas.h>
+#include <btas/BlockSpTensor.hpp>
+
+#include "fermion.h"
+
+using namespace btas;
+
+typedef BlockSpTensor<double,2,fermion> matrix_t;
+typedef matrix_t::qnum_array_type qarray_t;
+typedef matrix_t::size_array_type narray_t;
+
+/// random block-sparse matrix, local blocks are filled on each proc.
+void random_matrix (
+  boost::mt19937& rGen, const fermion& q0,
+  const qarray_t& qr, const qarray_t& qc, const narray_t& nr, const narray_t& nc, matrix_t& a)
+{
+  boost::random::uniform_real_distribution<double> dist(-1.0,1.0);
+  a.resize(q0,make_array(qr,qc),make_array(nr,nc));
+  for(matrix_t::iterator it = a.begin(); it != a.end(); ++it)
+    for(size_t k = 0; k < it->size(); ++k) it->data()[k] = dist(rGen);
+}
+
+/// dense row-major copy of a on every proc. (collective)
+std::vector<double> to_dense (const matrix_t& a, size_t& rows, size_t& cols)
+{
+  const narray_t& nr = a.size_array(0);
+  const narray_t& nc = a.size_array(1);
+  std::vector<size_t> ro(nr.size()+1,0), co(nc.size()+1,0);
+  std::partial_sum(nr.begin(),nr.end(),ro.begin()+1);
+  std::partial_sum(nc.begin(),nc.end(),co.begin()+1);
+  rows = ro.back();
+  cols = co.back();
+  std::vector<double> x(rows*cols,0.0);
+  for(size_t i = 0; i < nr.size(); ++i)
+    for(size_t j = 0; j < nc.size(); ++j) {
+      size_t ij = i*nc.size()+j;
+      if(!a.has(ij)) continue;
+      matrix_t::const_iterator it = a.get(ij);
+      for(size_t p = 0; p < nr[i]; ++p)
+        for(size_t q = 0; q < nc[j]; ++q) x[(ro[i]+p)*cols+co[j]+q] = it->data()[p*nc[j]+q];
+    }
+  a.cache_clear();
+  return x;
+}
+
+/// dense op(x), x is real thus ConjTrans is the same as Trans
+std::vector<double> dense_op (const CBLAS_TRANSPOSE& trans, const std::vector<double>& x, size_t& rows, size_t& cols)
+{
+  if(trans == CblasNoTrans) return x;
+  std::vector<double> y(x.size());
+  for(size_t i = 0; i < rows; ++i)
+    for(size_t j = 0; j < cols; ++j) y[j*rows+i] = x[i*cols+j];
+  std::swap(rows,cols);
+  return y;
+}
+
+/// stored matrix s.t. op(a) has row qnum's qr and col qnum's qc with total qnum q0
+void make_operand (
+  boost::mt19937& rGen, const CBLAS_TRANSPOSE& trans, const fermion& q0,
+  const qarray_t& qr, const qarray_t& qc, const narray_t& nr, const narray_t& nc, matrix_t& a)
+{
+  if(trans == CblasNoTrans)
+    random_matrix(rGen,q0,qr,qc,nr,nc,a);
+  else if(trans == CblasTrans)
+    random_matrix(rGen,q0,qc,qr,nc,nr,a);
+  else
+    random_matrix(rGen,q0.conj(),conj(qc),conj(qr),nc,nr,a);
+}
+
+const char* trans_name (const CBLAS_TRANSPOSE& trans)
+{
+  if(trans == CblasNoTrans) return "N";
+  if(trans == CblasTrans)   return "T";
+  return "C";
+}
+
+int main (int argc, char* argv[])
+{
+  boost::mpi::environment env(argc,argv);
+  boost::mpi::communicator world;
+
+  boost::mt19937 rGen(world.rank());
+
+  qarray_t qa;
+  qa.push_back(fermion(0, 0));
+  qa.push_back(fermion(1, 1));
+  qa.push_back(fermion(1,-1));
+  qa.push_back(fermion(2, 2));
+  qa.push_back(fermion(2, 0));
+  qa.push_back(fermion(2,-2));
+  qa.push_back(fermion(3, 1));
+  qa.push_back(fermion(3,-1));
+
+  // different block sizes for rows, contracted and cols to detect a wrong stride
+  narray_t na, nk, nb;
+  for(size_t i = 0; i < qa.size(); ++i) {
+    na.push_back(1+i%3);
+    nk.push_back(2+i%2);
+    nb.push_back(3-i%3);
+  }
+
+  // op(a) : qa x conj(qa) with qnum (1,1), op(b) : qa x conj(qa) with qnum (1,-1)
+  fermion qA(1, 1);
+  fermion qB(1,-1);
+
+  const CBLAS_TRANSPOSE trans[] = { CblasNoTrans, CblasTrans, CblasConjTrans };
+
+  int nFail = 0;
+
+  if(world.rank() == 0) {
+    std::cout.setf(std::ios::scientific,std::ios::floatfield);
+    std::cout.precision(2);
+    std::cout << "Block-sparse gemm vs. dense gemm of explicitly transposed operands :: " << std::endl;
+  }
+
+  for(int ta = 0; ta < 3; ++ta)
+  for(int tb = 0; tb < 3; ++tb) {
+    matrix_t a, b, c;
+    make_operand(rGen,trans[ta],qA,qa,conj(qa),na,nk,a);
+    make_operand(rGen,trans[tb],qB,qa,conj(qa),nk,nb,b);
+
+    // c is constructed by gemm, then accumulated with beta = 0.5
+    gemm(trans[ta],trans[tb],1.0,a,b,1.0,c);
+    gemm(trans[ta],trans[tb],1.0,a,b,0.5,c);
+
+    size_t aRows, aCols, bRows, bCols, cRows, cCols;
+    std::vector<double> aRef = dense_op(trans[ta],to_dense(a,aRows,aCols),aRows,aCols);
+    std::vector<double> bRef = dense_op(trans[tb],to_dense(b,bRows,bCols),bRows,bCols);
+    std::vector<double> cDns = to_dense(c,cRows,cCols);
+    size_t nnzC = c.nnz();
+
+    bool fail = (aRows != cRows || bCols != cCols || aCols != bRows);
+    double err = 0.0;
+    double nrm = 0.0;
+    if(!fail) {
+      std::vector<double> cRef(cRows*cCols,0.0);
+      gemm(CblasRowMajor,CblasNoTrans,CblasNoTrans,cRows,cCols,aCols,1.5,aRef.data(),aCols,bRef.data(),bCols,0.0,cRef.data(),cCols);
+      for(size_t k = 0; k < cRef.size(); ++k) {
+        err = std::max(err,std::fabs(cDns[k]-cRef[k]));
+        nrm = std::max(nrm,std::fabs(cRef[k]));
+      }
+      fail = (nrm == 0.0 || err > 1.0e-12);
+    }
+    if(world.rank() == 0)
+      std::cout << "\t" << trans_name(trans[ta]) << trans_name(trans[tb]) << " : " << std::setw(3) << cRows << " x " << std::setw(3) << cCols
+                << " nnz = " << std::setw(3) << nnzC << " max|C| = " << nrm << " max|dC| = " << err << (fail ? " FAIL" : "") << std::endl;
+    if(fail) ++nFail;
+  }
+
+#ifdef _OPENMP
+  // local block gemm tasks are threaded, each c[ij] is computed by a single thread in the same order,
+  // thus the result must be bitwise identical to the one with a single thread
+  if(world.rank() == 0)
+    std::cout << "Threaded vs. single-threaded block-sparse gemm :: " << std::endl;
+  {
+    narray_t nl(qa.size(),16);
+    matrix_t a, b;
+    random_matrix(rGen,fermion(0,0),qa,conj(qa),nl,nl,a);
+    random_matrix(rGen,fermion(0,0),qa,conj(qa),nl,nl,b);
+
+    int nThreads = std::max(omp_get_max_threads(),4);
+    int nSaved = omp_get_max_threads();
+    matrix_t c1, cN;
+    omp_set_num_threads(1);
+    gemm(CblasNoTrans,CblasNoTrans,1.0,a,b,1.0,c1);
+    omp_set_num_threads(nThreads);
+    gemm(CblasNoTrans,CblasNoTrans,1.0,a,b,1.0,cN);
+    omp_set_num_threads(nSaved);
+
+    int diff = 0;
+    for(size_t i = 0; i < c1.size(); ++i) {
+      if(!c1.is_local(i)) continue;
+      if(!std::equal(c1[i].begin(),c1[i].end(),cN[i].begin())) ++diff;
+    }
+    diff = boost::mpi::all_reduce(world,diff,std::plus<int>());
+    size_t nnzC = c1.nnz();
+    if(world.rank() == 0)
+      std::cout << "	" << nThreads << " threads : nnz = " << nnzC << " blocks differ = " << diff << (diff ? " FAIL" : "") << std::endl;
+    if(diff) ++nFail;
+  }
+#endif
+
+  if(world.rank() == 0) {
+    if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+    else
+      std::cout << "FAIL: " << nFail << " cases" << std::endl;
+  }
+
+  return nFail;
+}
@@ -0,0 +1,298 @@
+#ifndef __BTAS_LAPACK_DRIVER_POLICY_H
+#define __BTAS_LAPACK_DRIVER_POLICY_H
+
+#include <vector>
+#include <algorithm>
+#include <cctype>
+
+#include <lapack/types.h>
+#include <lapack/gesvd_impl.h>
+#include <lapack/gesdd_impl.h>
+#include <lapack/syev_impl.h>
+#include <lapack/syevd_impl.h>
+#include <lapack/syevr_impl.h>
+#include <lapack/heev_impl.h>
+#include <lapack/heevd_impl.h>
+#include <lapack/jacobi_impl.h>
+#include <lapack/gram_svd_impl.h>
+
+namespace btas {
+
+/// LAPACK driver for singular value decomposition
+enum BTAS_SVD_DRIVER
+{
+  SvdAuto,  ///< selected by lapack_driver_policy
+  SvdGesvd, ///< QR iteration
+  SvdGesdd, ///< divide-and-conquer
+  SvdJacobi, ///< one-sided Jacobi for tiny real matrices, falls back to gesvd otherwise
+  SvdGram    ///< eigenvalue decomposition of Gram matrix for strongly rectangular real matrices, falls back to SvdAuto otherwise
+};
+
+/// LAPACK driver for real-symmetric / hermitian eigenvalue problem
+enum BTAS_EIG_DRIVER
+{
+  EigAuto,  ///< selected by lapack_driver_policy
+  EigSyev,  ///< QR iteration
+  EigSyevd, ///< divide-and-conquer
+  EigSyevr, ///< MRRR, which can compute selected eigenpairs (real only, hermitian falls back to divide-and-conquer)
+  EigJacobi ///< cyclic Jacobi for tiny real matrices, falls back to syev/heev otherwise
+};
+
+/// Automatic selection of LAPACK drivers
+/// Divide-and-conquer drivers are faster than QR iteration except for tiny matrices,
+/// and MRRR is preferred if only a small part of the spectrum is needed.
+/// Tiny matrices are decomposed by Jacobi kernels without calling LAPACK.
+/// Crossovers are global and can be tuned for the linked LAPACK library.
+struct lapack_driver_policy
+{
+  /// min(M,N) from which gesdd is used
+  static size_t& svd_crossover () { static size_t n = 32; return n; }
+
+  /// N from which syevd/heevd is used
+  static size_t& eig_crossover () { static size_t n = 32; return n; }
+
+  /// syevr is used if number of wanted eigenpairs is less than this fraction of N
+  static double& eig_partial_ratio () { static double r = 0.5; return r; }
+
+  /// max(M,N) up to which one-sided Jacobi SVD is used, must not exceed BTAS_JACOBI_NMAX
+  static size_t& jacobi_svd_crossover () { static size_t n = 12; return n; }
+
+  /// N up to which Jacobi eigensolver is used, must not exceed BTAS_JACOBI_NMAX
+  static size_t& jacobi_eig_crossover () { static size_t n = 8; return n; }
+
+  /// min. aspect ratio max(M,N)/min(M,N) for which Gram matrix SVD is used when selected
+  static double& gram_svd_aspect () { static double r = 2.0; return r; }
+
+  /// min(M,N) from which Gram matrix SVD is used when selected, smaller matrices are left to Jacobi or gesvd
+  static size_t& gram_svd_crossover () { static size_t n = 16; return n; }
+
+  /// Gram matrix SVD falls back to full SVD if the smallest singular value is less than this fraction of the largest,
+  /// since its relative error is eps * (s_max / s)^2
+  static double& gram_svd_tolerance () { static double r = 1.0e-4; return r; }
+
+  /// whether Gram matrix SVD can be used
+  static bool gram_svd (const char& jobu, const char& jobvt, const size_t& M, const size_t& N)
+  {
+    if(toupper(jobu) == 'A' || toupper(jobu) == 'O' || toupper(jobvt) == 'A' || toupper(jobvt) == 'O') return false;
+    const size_t K = std::min(M,N);
+    return K >= gram_svd_crossover() && std::max(M,N) >= gram_svd_aspect()*K;
+  }
+
+  /// select SVD driver
+  /// gesdd takes the same job for U and VT, otherwise gesvd is used
+  static BTAS_SVD_DRIVER svd (const char& jobu, const char& jobvt, const size_t& M, const size_t& N)
+  {
+    if(toupper(jobu) == 'O' || toupper(jobvt) == 'O') return SvdGesvd;
+    if(std::max(M,N) <= std::min<size_t>(jacobi_svd_crossover(),BTAS_JACOBI_NMAX)) return SvdJacobi;
+    if(toupper(jobu) != toupper(jobvt)) return SvdGesvd;
+    return (std::min(M,N) >= svd_crossover()) ? SvdGesdd : SvdGesvd;
+  }
+
+  /// select eigensolver
+  /// \param nev number of wanted eigenpairs from the lowest, 0 means all
+  static BTAS_EIG_DRIVER eig (const size_t& N, const size_t& nev = 0)
+  {
+    if(N <= std::min<size_t>(jacobi_eig_crossover(),BTAS_JACOBI_NMAX)) return EigJacobi;
+    if(nev > 0 && nev < N && nev < eig_partial_ratio()*N) return EigSyevr;
+    return (N >= eig_crossover()) ? EigSyevd : EigSyev;
+  }
+};
+
+/// SVD by Gram matrix if it can be used (see lapack_driver_policy::gram_svd), A is not destroyed
+/// \return false if Gram matrix SVD isn't used, or s_min < tol * s_max, then U and VT are not stored
+template<typename T, typename RealType>
+bool gesvd_gram (
+  const int& order,
+  const char& jobu,
+  const char& jobvt,
+  const size_t& M,
+  const size_t& N,
+  const T* A,
+  const size_t& ldA,
+        RealType* S,
+        T* U,
+  const size_t& ldU,
+        T* VT,
+  const size_t& ldVT,
+  const RealType& tol)
+{
+  if(!lapack_driver_policy::gram_svd(jobu,jobvt,M,N)) return false;
+  return gram_svd_kernel<T>::gesvd(order,jobu,jobvt,M,N,A,ldA,S,U,ldU,VT,ldVT,tol);
+}
+
+/// SVD by specified driver
+template<typename T, typename RealType>
+void gesvd (
+  const BTAS_SVD_DRIVER& driver,
+  const int& order,
+  const char& jobu,
+  const char& jobvt,
+  const size_t& M,
+  const size_t& N,
+        T* A,
+  const size_t& ldA,
+        RealType* S,
+        T* U,
+  const size_t& ldU,
+        T* VT,
+  const size_t& ldVT)
+{
+  BTAS_SVD_DRIVER selected = (driver == SvdAuto) ? lapack_driver_policy::svd(jobu,jobvt,M,N) : driver;
+  if(selected == SvdGram) {
+    if(gesvd_gram(order,jobu,jobvt,M,N,A,ldA,S,U,ldU,VT,ldVT,static_cast<RealType>(lapack_driver_policy::gram_svd_tolerance()))) return;
+    selected = lapack_driver_policy::svd(jobu,jobvt,M,N);
+  }
+  if(selected == SvdJacobi) {
+    if(jacobi_kernel<T>::gesvd(order,jobu,jobvt,M,N,A,ldA,S,U,ldU,VT,ldVT)) return;
+    selected = SvdGesvd;
+  }
+  if(selected == SvdGesdd) {
+    BTAS_ASSERT(toupper(jobu) == toupper(jobvt), "gesvd: gesdd requires the same job for U and VT.");
+    gesdd(order,jobu,M,N,A,ldA,S,U,ldU,VT,ldVT);
+  }
+  else {
+    gesvd(order,jobu,jobvt,M,N,A,ldA,S,U,ldU,VT,ldVT);
+  }
+}
+
+/// Solve real-symmetric eigenvalue problem by specified driver
+/// Eigenvalues are stored in ascending order.
+/// \param A on entry, symmetric matrix, destroyed on exit
+/// \param W eigenvalues, nev elements
+/// \param nev number of the lowest eigenpairs to be stored, 0 means all
+/// \param Z eigenvectors in columns, N x nev matrix. Z may be the same as A, then ldZ must be ldA.
+/// \return number of eigenpairs stored
+template<typename T>
+size_t syev (
+  const BTAS_EIG_DRIVER& driver,
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        T* A,
+  const size_t& ldA,
+        T* W,
+  const size_t& nev,
+        T* Z,
+  const size_t& ldZ)
+{
+  size_t nW = (nev > 0 && nev < N) ? nev : N;
+
+  // LAPACK needs N elements for eigenvalues, even if partially computed
+  std::vector<T> wAll(N);
+
+  BTAS_EIG_DRIVER selected = (driver == EigAuto) ? lapack_driver_policy::eig(N,nev) : driver;
+  if(selected == EigSyevr) {
+    // syevr does not work in place
+    std::vector<T> aCp;
+    if(A == Z) aCp.assign(A,A+N*ldA);
+    T* pA = (A == Z) ? aCp.data() : A;
+    size_t M;
+    syevr(order,jobz,(nW < N) ? 'I' : 'A',uplo,N,pA,ldA,static_cast<T>(0),static_cast<T>(0),1,nW,static_cast<T>(0),M,wAll.data(),Z,ldZ);
+    std::copy(wAll.begin(),wAll.begin()+M,W);
+    return M;
+  }
+
+  if(selected != EigJacobi || !jacobi_kernel<T>::syev(order,jobz,uplo,N,A,ldA,wAll.data())) {
+    if(selected == EigSyevd)
+      syevd(order,jobz,uplo,N,A,ldA,wAll.data());
+    else
+      syev (order,jobz,uplo,N,A,ldA,wAll.data());
+  }
+
+  std::copy(wAll.begin(),wAll.begin()+nW,W);
+
+  // copy leading eigenvectors
+  if(A != Z && (jobz == 'V' || jobz == 'v')) {
+    if(order == LAPACK_ROW_MAJOR) {
+      for(size_t i = 0; i < N; ++i)
+        std::copy(A+i*ldA,A+i*ldA+nW,Z+i*ldZ);
+    }
+    else {
+      for(size_t j = 0; j < nW; ++j)
+        std::copy(A+j*ldA,A+j*ldA+N,Z+j*ldZ);
+    }
+  }
+  return nW;
+}
+
+/// Solve hermitian eigenvalue problem by specified driver
+/// Same as syev but MRRR is not supported for complex, and is replaced by divide-and-conquer.
+template<typename T, typename RealType>
+size_t heev (
+  const BTAS_EIG_DRIVER& driver,
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        T* A,
+  const size_t& ldA,
+        RealType* W,
+  const size_t& nev,
+        T* Z,
+  const size_t& ldZ)
+{
+  size_t nW = (nev > 0 && nev < N) ? nev : N;
+
+  BTAS_EIG_DRIVER selected = (driver == EigAuto) ? lapack_driver_policy::eig(N,nev) : driver;
+  // LAPACK needs N elements for eigenvalues
+  std::vector<RealType> wAll(N);
+
+  if(selected == EigSyev || selected == EigJacobi)
+    heev (order,jobz,uplo,N,A,ldA,wAll.data());
+  else
+    heevd(order,jobz,uplo,N,A,ldA,wAll.data());
+
+  std::copy(wAll.begin(),wAll.begin()+nW,W);
+
+  // copy leading eigenvectors
+  if(A != Z && (jobz == 'V' || jobz == 'v')) {
+    if(order == LAPACK_ROW_MAJOR) {
+      for(size_t i = 0; i < N; ++i)
+        std::copy(A+i*ldA,A+i*ldA+nW,Z+i*ldZ);
+    }
+    else {
+      for(size_t j = 0; j < nW; ++j)
+        std::copy(A+j*ldA,A+j*ldA+N,Z+j*ldZ);
+    }
+  }
+  return nW;
+}
+
+/// for float: redirect to syev
+inline size_t heev (
+  const BTAS_EIG_DRIVER& driver,
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        float* A,
+  const size_t& ldA,
+        float* W,
+  const size_t& nev,
+        float* Z,
+  const size_t& ldZ)
+{
+  return syev(driver,order,jobz,uplo,N,A,ldA,W,nev,Z,ldZ);
+}
+
+/// for double: redirect to syev
+inline size_t heev (
+  const BTAS_EIG_DRIVER& driver,
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        double* A,
+  const size_t& ldA,
+        double* W,
+  const size_t& nev,
+        double* Z,
+  const size_t& ldZ)
+{
+  return syev(driver,order,jobz,uplo,N,A,ldA,W,nev,Z,ldZ);
+}
+
+} // namespace btas
+
+#endif // __BTAS_LAPACK_DRIVER_POLICY_H
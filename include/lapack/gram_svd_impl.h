@@ -0,0 +1,142 @@
+#ifndef __BTAS_LAPACK_GRAM_SVD_IMPL_H
+#define __BTAS_LAPACK_GRAM_SVD_IMPL_H
+
+#include <cmath>
+#include <cctype>
+#include <vector>
+#include <complex>
+#include <algorithm>
+
+#include <blas/types.h>
+#include <blas/gemm_impl.h>
+#include <blas/syrk_impl.h>
+
+#include <lapack/types.h>
+#include <lapack/syevd_impl.h>
+
+namespace btas {
+
+/// SVD through eigenvalue decomposition of Gram matrix, for strongly rectangular real matrices
+/// For M >= N, G = A^T A = V S^2 V^T is formed by syrk and solved by syevd, then U = A V S^-1 by gemm.
+/// For M < N, G = A A^T = U S^2 U^T, then V^T = S^-1 U^T A.
+/// All work is done by BLAS-3 and the eigensolver of min(M,N) x min(M,N) matrix, which is much faster than gesvd
+/// for tall-skinny (short-wide) matrices, but the relative error of singular value s is eps * (s_max / s)^2.
+/// Primary template is for real types, complex types are not supported.
+template<typename T>
+struct gram_svd_kernel
+{
+  /// SVD with the same arguments as gesvd, A is not destroyed
+  /// jobu and jobvt can be 'S' or 'N'
+  /// \param tol if s_min < tol * s_max, returns false without storing U and VT, so that full SVD can be called instead.
+  ///        With tol = 0, columns of U (rows of VT) for zero singular values are set to zero.
+  static bool gesvd (
+    const int& order,
+    const char& jobu,
+    const char& jobvt,
+    const size_t& M,
+    const size_t& N,
+    const T* A,
+    const size_t& ldA,
+          T* S,
+          T* U,
+    const size_t& ldU,
+          T* VT,
+    const size_t& ldVT,
+    const T& tol)
+  {
+    // column-major A is row-major A^T = V S U^T
+    if(order == LAPACK_COL_MAJOR)
+      return gesvd_row_major(jobvt,jobu,N,M,A,ldA,S,VT,ldVT,U,ldU,tol);
+    else
+      return gesvd_row_major(jobu,jobvt,M,N,A,ldA,S,U,ldU,VT,ldVT,tol);
+  }
+
+private:
+
+  static bool gesvd_row_major (
+    const char& jobu,
+    const char& jobvt,
+    const size_t& M,
+    const size_t& N,
+    const T* A,
+    const size_t& ldA,
+          T* S,
+          T* U,
+    const size_t& ldU,
+          T* VT,
+    const size_t& ldVT,
+    const T& tol)
+  {
+    const char ju = toupper(jobu);
+    const char jv = toupper(jobvt);
+    if((ju != 'S' && ju != 'N') || (jv != 'S' && jv != 'N')) return false;
+    if(M == 0 || N == 0) return true;
+
+    const bool tall = (M >= N);
+    const size_t K = tall ? N : M;
+
+    // Gram matrix of short side, eigenvectors are stored in columns on exit
+    std::vector<T> G(K*K);
+    std::vector<T> W(K);
+    syrk(CblasRowMajor,CblasUpper,tall ? CblasTrans : CblasNoTrans,K,tall ? M : N,static_cast<T>(1),A,ldA,static_cast<T>(0),G.data(),K);
+    syevd(LAPACK_ROW_MAJOR,'V','U',K,G.data(),K,W.data());
+
+    // singular values in descending order
+    for(size_t k = 0; k < K; ++k) S[k] = std::sqrt(std::max(W[K-1-k],static_cast<T>(0)));
+    if(tol > 0 && !(S[K-1] >= tol*S[0])) return false;
+
+    // short side vectors in descending order, X(i,k) = G(i,K-1-k)
+    std::vector<T> X(K*K);
+    for(size_t i = 0; i < K; ++i)
+      for(size_t k = 0; k < K; ++k) X[i*K+k] = G[i*K+K-1-k];
+
+    const char jl = tall ? ju : jv; // job for long side vectors, computed by gemm
+    const char js = tall ? jv : ju; // job for short side vectors
+
+    if(js != 'N') {
+      if(tall) {
+        // VT(k,j) = X(j,k)
+        for(size_t k = 0; k < K; ++k)
+          for(size_t j = 0; j < K; ++j) VT[k*ldVT+j] = X[j*K+k];
+      }
+      else {
+        for(size_t i = 0; i < K; ++i)
+          std::copy(X.begin()+i*K,X.begin()+(i+1)*K,U+i*ldU);
+      }
+    }
+
+    if(jl != 'N') {
+      // inverse of singular values, zero for null space
+      std::vector<T> sinv(K);
+      for(size_t k = 0; k < K; ++k) sinv[k] = (S[k] > 0) ? static_cast<T>(1)/S[k] : static_cast<T>(0);
+      if(tall) {
+        // U = A X S^-1
+        gemm(CblasRowMajor,CblasNoTrans,CblasNoTrans,M,K,K,static_cast<T>(1),A,ldA,X.data(),K,static_cast<T>(0),U,ldU);
+        for(size_t i = 0; i < M; ++i)
+          for(size_t k = 0; k < K; ++k) U[i*ldU+k] *= sinv[k];
+      }
+      else {
+        // VT = S^-1 X^T A
+        gemm(CblasRowMajor,CblasTrans,CblasNoTrans,K,N,K,static_cast<T>(1),X.data(),K,A,ldA,static_cast<T>(0),VT,ldVT);
+        for(size_t k = 0; k < K; ++k)
+          for(size_t j = 0; j < N; ++j) VT[k*ldVT+j] *= sinv[k];
+      }
+    }
+
+    return true;
+  }
+};
+
+/// Complex types are not supported, always fall back to LAPACK
+template<typename T>
+struct gram_svd_kernel<std::complex<T>>
+{
+  template<typename RealType>
+  static bool gesvd (const int&, const char&, const char&, const size_t&, const size_t&,
+                     const std::complex<T>*, const size_t&, RealType*, std::complex<T>*, const size_t&, std::complex<T>*, const size_t&, const RealType&)
+  { return false; }
+};
+
+} // namespace btas
+
+#endif // __BTAS_LAPACK_GRAM_SVD_IMPL_H
@@ -0,0 +1,74 @@
+#ifndef __BTAS_LAPACK_HEEVD_IMPL_H
+#define __BTAS_LAPACK_HEEVD_IMPL_H
+
+#include <lapack/types.h>
+
+namespace btas {
+
+/// Hermitian eigenvalue problem by divide-and-conquer algorithm
+template<typename T, typename RealType>
+void heevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        T* A,
+  const size_t& ldA,
+        RealType* W)
+{
+  BTAS_ASSERT(false, "heevd is not implemented.");
+}
+
+/// for float: redirect to ssyevd
+inline void heevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        float* A,
+  const size_t& ldA,
+        float* W)
+{
+  LAPACKE_ssyevd(order, jobz, uplo, N, A, ldA, W);
+}
+
+/// for double: redirect to dsyevd
+inline void heevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        double* A,
+  const size_t& ldA,
+        double* W)
+{
+  LAPACKE_dsyevd(order, jobz, uplo, N, A, ldA, W);
+}
+
+inline void heevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        std::complex<float>* A,
+  const size_t& ldA,
+        float* W)
+{
+  LAPACKE_cheevd(order, jobz, uplo, N, A, ldA, W);
+}
+
+inline void heevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        std::complex<double>* A,
+  const size_t& ldA,
+        double* W)
+{
+  LAPACKE_zheevd(order, jobz, uplo, N, A, ldA, W);
+}
+
+} // namespace btas
+
+#endif // __BTAS_LAPACK_HEEVD_IMPL_H
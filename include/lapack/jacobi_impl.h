@@ -0,0 +1,287 @@
+#ifndef __BTAS_LAPACK_JACOBI_IMPL_H
+#define __BTAS_LAPACK_JACOBI_IMPL_H
+
+#include <cmath>
+#include <cctype>
+#include <limits>
+#include <complex>
+#include <algorithm>
+
+#include <lapack/types.h>
+
+namespace btas {
+
+/// Maximum dimension of matrices decomposed by Jacobi kernels
+#ifndef BTAS_JACOBI_NMAX
+#define BTAS_JACOBI_NMAX 16
+#endif
+
+/// Jacobi kernels for tiny dense matrices
+/// All work space is allocated on the stack with fixed size NMAX x NMAX, so that no workspace query and heap allocation are needed.
+/// Each kernel returns false if the matrix is too large or the rotations are not converged, then LAPACK must be called instead.
+/// Primary template is for real types, complex types are not supported.
+template<typename T, size_t NMAX = BTAS_JACOBI_NMAX>
+struct jacobi_kernel
+{
+  /// max. number of sweeps
+  static const int MAX_SWEEPS = 60;
+
+  /// element (i,j) of matrix
+  static T& at (const int& order, T* A, const size_t& ld, const size_t& i, const size_t& j)
+  { return (order == LAPACK_ROW_MAJOR) ? A[i*ld+j] : A[i+j*ld]; }
+
+  /// element (i,j) of matrix
+  static const T& at (const int& order, const T* A, const size_t& ld, const size_t& i, const size_t& j)
+  { return (order == LAPACK_ROW_MAJOR) ? A[i*ld+j] : A[i+j*ld]; }
+
+  /// dot product of columns with length n, which are stored contiguously
+  static T dot (const size_t& n, const T* x, const T* y)
+  {
+    T value = static_cast<T>(0);
+    for(size_t i = 0; i < n; ++i) value += x[i]*y[i];
+    return value;
+  }
+
+  /// plane rotation of columns: x := c*x - s*y, y := s*x + c*y
+  static void rot (const size_t& n, T* x, T* y, const T& c, const T& s)
+  {
+    for(size_t i = 0; i < n; ++i) {
+      T xi = x[i];
+      T yi = y[i];
+      x[i] = c*xi - s*yi;
+      y[i] = s*xi + c*yi;
+    }
+  }
+
+  /// complete orthonormal columns w[k,n) of length m, from w[0,k) by Gram-Schmidt on unit vectors
+  /// the unit vector which has the largest component in the complement space is taken at each step
+  static void complete (const size_t& m, const size_t& k, const size_t& n, T* w)
+  {
+    T x[NMAX];
+    for(size_t j = k; j < n; ++j) {
+      T* wj = w+j*NMAX;
+      T xmax = static_cast<T>(-1);
+      for(size_t e = 0; e < m; ++e) {
+        std::fill(x,x+m,static_cast<T>(0));
+        x[e] = static_cast<T>(1);
+        // orthogonalize twice for numerical stability
+        for(int twice = 0; twice < 2; ++twice)
+          for(size_t i = 0; i < j; ++i) {
+            T* y = w+i*NMAX;
+            T xy = dot(m,x,y);
+            for(size_t r = 0; r < m; ++r) x[r] -= xy*y[r];
+          }
+        T xnorm = std::sqrt(dot(m,x,x));
+        if(xnorm > xmax) {
+          xmax = xnorm;
+          for(size_t r = 0; r < m; ++r) wj[r] = x[r]/xnorm;
+        }
+      }
+    }
+  }
+
+  /// SVD by one-sided Jacobi (Hestenes) method, with the same arguments as gesvd
+  /// jobu and jobvt can be 'A', 'S' or 'N'
+  static bool gesvd (
+    const int& order,
+    const char& jobu,
+    const char& jobvt,
+    const size_t& M,
+    const size_t& N,
+    const T* A,
+    const size_t& ldA,
+          T* S,
+          T* U,
+    const size_t& ldU,
+          T* VT,
+    const size_t& ldVT)
+  {
+    const char ju = toupper(jobu);
+    const char jv = toupper(jobvt);
+    if(M > NMAX || N > NMAX || ju == 'O' || jv == 'O') return false;
+    if(M == 0 || N == 0) return true;
+
+    // rotations are applied to columns of A if M >= N, otherwise to columns of A^T
+    const bool trans = (M < N);
+    const size_t m = trans ? N : M; // long side
+    const size_t n = trans ? M : N; // short side
+
+    T w[NMAX*NMAX]; // column j is stored in w[j*NMAX, j*NMAX+m)
+    T v[NMAX*NMAX]; // column j is stored in v[j*NMAX, j*NMAX+n)
+
+    for(size_t j = 0; j < n; ++j) {
+      for(size_t i = 0; i < m; ++i)
+        w[j*NMAX+i] = trans ? at(order,A,ldA,j,i) : at(order,A,ldA,i,j);
+      for(size_t i = 0; i < n; ++i)
+        v[j*NMAX+i] = (i == j) ? static_cast<T>(1) : static_cast<T>(0);
+    }
+
+    const T eps = std::numeric_limits<T>::epsilon();
+
+    bool converged = false;
+    for(int sweep = 0; sweep < MAX_SWEEPS && !converged; ++sweep) {
+      converged = true;
+      for(size_t p = 0; p+1 < n; ++p)
+        for(size_t q = p+1; q < n; ++q) {
+          T alpha = dot(m,w+p*NMAX,w+p*NMAX);
+          T beta  = dot(m,w+q*NMAX,w+q*NMAX);
+          T gamma = dot(m,w+p*NMAX,w+q*NMAX);
+          if(std::fabs(gamma) <= eps*std::sqrt(alpha*beta)) continue;
+          converged = false;
+          T zeta = (beta-alpha)/(2*gamma);
+          T t = ((zeta >= 0) ? 1 : -1)/(std::fabs(zeta)+std::sqrt(1+zeta*zeta));
+          T c = 1/std::sqrt(1+t*t);
+          T s = c*t;
+          rot(m,w+p*NMAX,w+q*NMAX,c,s);
+          rot(n,v+p*NMAX,v+q*NMAX,c,s);
+        }
+    }
+    if(!converged) return false;
+
+    // singular values are norms of rotated columns, sorted in descending order
+    T sigma[NMAX];
+    size_t perm[NMAX];
+    for(size_t j = 0; j < n; ++j) {
+      sigma[j] = std::sqrt(dot(m,w+j*NMAX,w+j*NMAX));
+      perm[j] = j;
+    }
+    for(size_t j = 1; j < n; ++j)
+      for(size_t i = j; i > 0 && sigma[perm[i-1]] < sigma[perm[i]]; --i) std::swap(perm[i-1],perm[i]);
+
+    // reorder columns
+    T wtmp[NMAX*NMAX];
+    T vtmp[NMAX*NMAX];
+    std::copy(w,w+n*NMAX,wtmp);
+    std::copy(v,v+n*NMAX,vtmp);
+    for(size_t j = 0; j < n; ++j) {
+      S[j] = sigma[perm[j]];
+      std::copy(wtmp+perm[j]*NMAX,wtmp+perm[j]*NMAX+m,w+j*NMAX);
+      std::copy(vtmp+perm[j]*NMAX,vtmp+perm[j]*NMAX+n,v+j*NMAX);
+    }
+
+    // left vectors of long side are normalized columns, null columns are completed
+    const char jl = trans ? jv : ju;
+    const char js = trans ? ju : jv;
+    size_t rank = 0;
+    for(; rank < n && S[rank] > S[0]*m*eps; ++rank)
+      for(size_t i = 0; i < m; ++i) w[rank*NMAX+i] /= S[rank];
+    const size_t nl = (jl == 'A') ? m : n;
+    if(jl != 'N') complete(m,rank,nl,w);
+
+    // store u and vt
+    T* L = trans ? VT : U;
+    T* R = trans ? U : VT;
+    const size_t ldL = trans ? ldVT : ldU;
+    const size_t ldR = trans ? ldU : ldVT;
+    if(jl != 'N')
+      for(size_t j = 0; j < nl; ++j)
+        for(size_t i = 0; i < m; ++i) {
+          if(trans) at(order,L,ldL,j,i) = w[j*NMAX+i];
+          else      at(order,L,ldL,i,j) = w[j*NMAX+i];
+        }
+    if(js != 'N')
+      for(size_t j = 0; j < n; ++j)
+        for(size_t i = 0; i < n; ++i) {
+          if(trans) at(order,R,ldR,i,j) = v[j*NMAX+i];
+          else      at(order,R,ldR,j,i) = v[j*NMAX+i];
+        }
+
+    return true;
+  }
+
+  /// real-symmetric eigenvalue problem by cyclic Jacobi method, with the same arguments as syev
+  /// eigenvalues are stored in ascending order
+  static bool syev (
+    const int& order,
+    const char& jobz,
+    const char& uplo,
+    const size_t& N,
+          T* A,
+    const size_t& ldA,
+          T* W)
+  {
+    if(N > NMAX) return false;
+    if(N == 0) return true;
+
+    const bool upper = (toupper(uplo) == 'U');
+
+    T a[NMAX*NMAX]; // full symmetric matrix, a(i,j) = a[i*NMAX+j]
+    T v[NMAX*NMAX]; // column j is stored in v[j*NMAX, j*NMAX+N)
+
+    T anorm = static_cast<T>(0);
+    for(size_t i = 0; i < N; ++i)
+      for(size_t j = i; j < N; ++j) {
+        T aij = upper ? at(order,A,ldA,i,j) : at(order,A,ldA,j,i);
+        a[i*NMAX+j] = aij;
+        a[j*NMAX+i] = aij;
+        anorm += (i == j) ? aij*aij : 2*aij*aij;
+      }
+    for(size_t j = 0; j < N; ++j)
+      for(size_t i = 0; i < N; ++i)
+        v[j*NMAX+i] = (i == j) ? static_cast<T>(1) : static_cast<T>(0);
+
+    const T eps = std::numeric_limits<T>::epsilon();
+
+    bool converged = false;
+    for(int sweep = 0; sweep < MAX_SWEEPS; ++sweep) {
+      T off = static_cast<T>(0);
+      for(size_t p = 0; p+1 < N; ++p)
+        for(size_t q = p+1; q < N; ++q) off += a[p*NMAX+q]*a[p*NMAX+q];
+      if(off <= eps*eps*anorm) { converged = true; break; }
+
+      for(size_t p = 0; p+1 < N; ++p)
+        for(size_t q = p+1; q < N; ++q) {
+          T apq = a[p*NMAX+q];
+          if(apq == static_cast<T>(0)) continue;
+          T theta = (a[q*NMAX+q]-a[p*NMAX+p])/(2*apq);
+          T t = ((theta >= 0) ? 1 : -1)/(std::fabs(theta)+std::sqrt(theta*theta+1));
+          T c = 1/std::sqrt(t*t+1);
+          T s = t*c;
+          a[p*NMAX+p] -= t*apq;
+          a[q*NMAX+q] += t*apq;
+          a[p*NMAX+q] = static_cast<T>(0);
+          a[q*NMAX+p] = static_cast<T>(0);
+          for(size_t r = 0; r < N; ++r) {
+            if(r == p || r == q) continue;
+            T arp = a[r*NMAX+p];
+            T arq = a[r*NMAX+q];
+            a[r*NMAX+p] = a[p*NMAX+r] = c*arp - s*arq;
+            a[r*NMAX+q] = a[q*NMAX+r] = s*arp + c*arq;
+          }
+          rot(N,v+p*NMAX,v+q*NMAX,c,s);
+        }
+    }
+    if(!converged) return false;
+
+    size_t perm[NMAX];
+    for(size_t j = 0; j < N; ++j) perm[j] = j;
+    for(size_t j = 1; j < N; ++j)
+      for(size_t i = j; i > 0 && a[perm[i-1]*(NMAX+1)] > a[perm[i]*(NMAX+1)]; --i) std::swap(perm[i-1],perm[i]);
+
+    for(size_t j = 0; j < N; ++j) W[j] = a[perm[j]*(NMAX+1)];
+
+    if(toupper(jobz) == 'V')
+      for(size_t j = 0; j < N; ++j)
+        for(size_t i = 0; i < N; ++i) at(order,A,ldA,i,j) = v[perm[j]*NMAX+i];
+
+    return true;
+  }
+};
+
+/// Complex types are not supported, always fall back to LAPACK
+template<typename T, size_t NMAX>
+struct jacobi_kernel<std::complex<T>, NMAX>
+{
+  template<typename RealType>
+  static bool gesvd (const int&, const char&, const char&, const size_t&, const size_t&,
+                     const std::complex<T>*, const size_t&, RealType*, std::complex<T>*, const size_t&, std::complex<T>*, const size_t&)
+  { return false; }
+
+  template<typename RealType>
+  static bool syev (const int&, const char&, const char&, const size_t&, std::complex<T>*, const size_t&, RealType*)
+  { return false; }
+};
+
+} // namespace btas
+
+#endif // __BTAS_LAPACK_JACOBI_IMPL_H
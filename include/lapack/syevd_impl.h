@@ -0,0 +1,48 @@
+#ifndef __BTAS_LAPACK_SYEVD_IMPL_H
+#define __BTAS_LAPACK_SYEVD_IMPL_H
+
+#include <lapack/types.h>
+
+namespace btas {
+
+/// Real-symmetric eigenvalue problem by divide-and-conquer algorithm
+template<typename T>
+void syevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        T* A,
+  const size_t& ldA,
+        T* W)
+{
+  BTAS_ASSERT(false, "syevd is not implemented.");
+}
+
+inline void syevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        float* A,
+  const size_t& ldA,
+        float* W)
+{
+  LAPACKE_ssyevd(order, jobz, uplo, N, A, ldA, W);
+}
+
+inline void syevd (
+  const int& order,
+  const char& jobz,
+  const char& uplo,
+  const size_t& N,
+        double* A,
+  const size_t& ldA,
+        double* W)
+{
+  LAPACKE_dsyevd(order, jobz, uplo, N, A, ldA, W);
+}
+
+} // namespace btas
+
+#endif // __BTAS_LAPACK_SYEVD_IMPL_H
@@ -0,0 +1,85 @@
+#ifndef __BTAS_LAPACK_SYEVR_IMPL_H
+#define __BTAS_LAPACK_SYEVR_IMPL_H
+
+#include <lapack/types.h>
+
+namespace btas {
+
+/// Real-symmetric eigenvalue problem by MRRR algorithm
+/// Selected eigenpairs can be computed by range = 'V' (vl < w <= vu) or 'I' (il-th through iu-th, 1-based)
+/// \param M on exit, number of eigenvalues found
+template<typename T>
+void syevr (
+  const int& order,
+  const char& jobz,
+  const char& range,
+  const char& uplo,
+  const size_t& N,
+        T* A,
+  const size_t& ldA,
+  const T& vl,
+  const T& vu,
+  const size_t& il,
+  const size_t& iu,
+  const T& abstol,
+        size_t& M,
+        T* W,
+        T* Z,
+  const size_t& ldZ)
+{
+  BTAS_ASSERT(false, "syevr is not implemented.");
+}
+
+inline void syevr (
+  const int& order,
+  const char& jobz,
+  const char& range,
+  const char& uplo,
+  const size_t& N,
+        float* A,
+  const size_t& ldA,
+  const float& vl,
+  const float& vu,
+  const size_t& il,
+  const size_t& iu,
+  const float& abstol,
+        size_t& M,
+        float* W,
+        float* Z,
+  const size_t& ldZ)
+{
+  lapack_int m;
+  lapack_int* isuppz = new lapack_int [2*N];
+  LAPACKE_ssyevr(order, jobz, range, uplo, N, A, ldA, vl, vu, il, iu, abstol, &m, W, Z, ldZ, isuppz);
+  delete [] isuppz;
+  M = m;
+}
+
+inline void syevr (
+  const int& order,
+  const char& jobz,
+  const char& range,
+  const char& uplo,
+  const size_t& N,
+        double* A,
+  const size_t& ldA,
+  const double& vl,
+  const double& vu,
+  const size_t& il,
+  const size_t& iu,
+  const double& abstol,
+        size_t& M,
+        double* W,
+        double* Z,
+  const size_t& ldZ)
+{
+  lapack_int m;
+  lapack_int* isuppz = new lapack_int [2*N];
+  LAPACKE_dsyevr(order, jobz, range, uplo, N, A, ldA, vl, vu, il, iu, abstol, &m, W, Z, ldZ, isuppz);
+  delete [] isuppz;
+  M = m;
+}
+
+} // namespace btas
+
+#endif // __BTAS_LAPACK_SYEVR_IMPL_H
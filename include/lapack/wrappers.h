@@ -2,15 +2,22 @@
 #define __BTAS_LAPACK_WRAPPERS_H
 
 #include <lapack/gesvd_impl.h>
+#include <lapack/gesdd_impl.h>
 #include <lapack/geqrf_impl.h>
 #include <lapack/orgqr_impl.h>
 #include <lapack/gelqf_impl.h>
 #include <lapack/orglq_impl.h>
 #include <lapack/syev_impl.h>
+#include <lapack/syevd_impl.h>
+#include <lapack/syevr_impl.h>
 #include <lapack/sygv_impl.h>
 #include <lapack/heev_impl.h>
+#include <lapack/heevd_impl.h>
 #include <lapack/getrf_impl.h>
 #include <lapack/getri_impl.h>
 #include <lapack/sytrs_impl.h>
 
+#include <lapack/jacobi_impl.h>
+#include <lapack/driver_policy.h>
+
 #endif // __BTAS_LAPACK_WRAPPERS_H
@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <random>
 
 #include <legacy/common/btas.h>
 #include <legacy/common/TVector.h>
@@ -20,13 +21,17 @@ namespace btas
 
    /// Solve real-symmetric eigenvalue problem (SEP)
    /// NOTE: if called with complex array, gives an error
+   /// If nev > 0, only nev lowest eigenpairs are computed
+   /// LAPACK driver is selected by lapack_driver_policy unless specified
    template<typename T, size_t N>
       void Syev (
             const char& jobz,
             const char& uplo,
             const TArray<T, 2*N-2>& a,
             TArray<T, 1>& d,
-            TArray<T, N>& z)
+            TArray<T, N>& z,
+            const size_t& nev = 0,
+            const BTAS_EIG_DRIVER& driver = EigAuto)
       {
          if(a.size() == 0) return;
 
@@ -35,16 +40,27 @@ namespace btas
 
          size_t colsA = std::accumulate(a.shape().begin()+K, a.shape().end(), 1ul, std::multiplies<size_t>());
 
+         size_t nEigen = (nev > 0 && nev < colsA) ? nev : colsA;
+
          IVector<N> shapeZ;
          for(size_t i = 0; i < N-1; ++i) shapeZ[i] = a.shape(i);
-         shapeZ[N-1] = colsA;
+         shapeZ[N-1] = nEigen;
 
-         z.resize(shapeZ);
-         CopyR(a, z);
+         d.resize(nEigen);
 
-         d.resize(colsA);
+         if(nEigen == colsA) {
+            z.resize(shapeZ);
+            CopyR(a, z);
 
-         syev(CblasRowMajor, jobz, uplo, colsA, z.data(), colsA, d.data());
+            syev(driver, CblasRowMajor, jobz, uplo, colsA, z.data(), colsA, d.data(), nEigen, z.data(), colsA);
+         }
+         else {
+            TArray<T, 2*N-2> acp(a);
+
+            z.resize(shapeZ);
+
+            syev(driver, CblasRowMajor, jobz, uplo, colsA, acp.data(), colsA, d.data(), nEigen, z.data(), nEigen);
+         }
       }
 
    /// Solve real-symmetric generalized eigenvalue problem (SGEP)
@@ -85,13 +101,17 @@ namespace btas
 
    /// Solve hermitian eigenvalue problem (HEP)
    /// NOTE: if called with real array, redirect to Syev
+   /// If nev > 0, only nev lowest eigenpairs are computed
+   /// LAPACK driver is selected by lapack_driver_policy unless specified
    template<typename T, size_t N>
       void Heev (
             const char& jobz,
             const char& uplo,
             const TArray<T, 2*N-2>& a,
             TArray<typename remove_complex<T>::type, 1>& d,
-            TArray<T, N>& z)
+            TArray<T, N>& z,
+            const size_t& nev = 0,
+            const BTAS_EIG_DRIVER& driver = EigAuto)
       {
          if(a.size() == 0) return;
 
@@ -100,19 +120,31 @@ namespace btas
 
          size_t colsA = std::accumulate(a.shape().begin()+K, a.shape().end(), 1ul, std::multiplies<size_t>());
 
+         size_t nEigen = (nev > 0 && nev < colsA) ? nev : colsA;
+
          IVector<N> shapeZ;
          for(size_t i = 0; i < N-1; ++i) shapeZ[i] = a.shape(i);
-         shapeZ[N-1] = colsA;
+         shapeZ[N-1] = nEigen;
 
-         z.resize(shapeZ);
-         CopyR(a, z);
+         d.resize(nEigen);
 
-         d.resize(colsA);
+         if(nEigen == colsA) {
+            z.resize(shapeZ);
+            CopyR(a, z);
 
-         heev(CblasRowMajor, jobz, uplo, colsA, z.data(), colsA, d.data());
+            heev(driver, CblasRowMajor, jobz, uplo, colsA, z.data(), colsA, d.data(), nEigen, z.data(), colsA);
+         }
+         else {
+            TArray<T, 2*N-2> acp(a);
+
+            z.resize(shapeZ);
+
+            heev(driver, CblasRowMajor, jobz, uplo, colsA, acp.data(), colsA, d.data(), nEigen, z.data(), nEigen);
+         }
       }
 
    /// Solve singular value decomposition (SVD)
+   /// LAPACK driver is selected by lapack_driver_policy unless specified
    template<typename T, size_t M, size_t N>
       void Gesvd (
             const char& jobu,
@@ -120,7 +152,8 @@ namespace btas
             const TArray<T, M>& a,
             TArray<typename remove_complex<T>::type, 1>& s,
             TArray<T, N>& u,
-            TArray<T, M-N+2>& vt)
+            TArray<T, M-N+2>& vt,
+            const BTAS_SVD_DRIVER& driver = SvdAuto)
       {
          if(a.size() == 0) return;
 
@@ -156,7 +189,7 @@ namespace btas
          vt.resize(shapeVt);
 
          TArray<T, M> acp(a);
-         gesvd(CblasRowMajor, jobu, jobvt, rowsA, colsA, acp.data(), ldA, s.data(), u.data(), ldU, vt.data(), ldVt);
+         gesvd(driver, CblasRowMajor, jobu, jobvt, rowsA, colsA, acp.data(), ldA, s.data(), u.data(), ldU, vt.data(), ldVt);
       }
 
    /// Solve singular value decomposition (SVD): compressing
@@ -167,7 +200,8 @@ namespace btas
             const TArray<T, M>& a,
             TArray<typename remove_complex<T>::type, 1>& s,
             TArray<T, N>& u,
-            TArray<T, M-N+2>& vt,int D)
+            TArray<T, M-N+2>& vt,int D,
+            const BTAS_SVD_DRIVER& driver = SvdAuto)
       {
 
          if(a.size() == 0)
@@ -207,7 +241,7 @@ namespace btas
          vt.resize(shapeVt);
 
          TArray<T, M> acp(a);
-         gesvd(CblasRowMajor, jobu, jobvt, rowsA, colsA, acp.data(), ldA, s.data(), u.data(), ldU, vt.data(), ldVt);
+         gesvd(driver, CblasRowMajor, jobu, jobvt, rowsA, colsA, acp.data(), ldA, s.data(), u.data(), ldU, vt.data(), ldVt);
 
          bool discard = true;
 
@@ -358,6 +392,201 @@ namespace btas
 
       }
 
+   /** perform a thin QR decomposition, A = Q * R
+    * Unlike the in-place version, A need not be tall: with K = min(rows, cols), Q has K columns and R has K rows.
+    * @param a input tensor of order M, first N-1 indices are taken as rows
+    * @param q tensor of order N with orthonormal columns, the last index has dimension K
+    * @param r upper triangular (trapezoidal) tensor of order M-N+2, the first index has dimension K
+    */
+   template<typename T, size_t M, size_t N>
+      void Geqrf (
+            const TArray<T, M>& a,
+            TArray<T, N>& q,
+            TArray<T, M-N+2>& r)
+      {
+         if(a.size() == 0) return;
+
+         const IVector<M>& shapeA = a.shape();
+
+         size_t rowsA = std::accumulate(shapeA.begin(), shapeA.begin()+N-1, 1ul, std::multiplies<size_t>());
+         size_t colsA = std::accumulate(shapeA.begin()+N-1, shapeA.end(), 1ul, std::multiplies<size_t>());
+
+         size_t nK = std::min(rowsA, colsA);
+
+         IVector<N> shapeQ;
+         for(size_t i = 0; i < N-1; ++i) shapeQ[i] = shapeA[i];
+         shapeQ[N-1] = nK;
+
+         IVector<M-N+2> shapeR;
+         shapeR[0] = nK;
+         for(size_t i = 1; i < M-N+2; ++i) shapeR[i] = shapeA[i+N-2];
+
+         TArray<T, M> acp(a);
+
+         std::vector<T> tau(nK);
+
+         geqrf(CblasRowMajor, rowsA, colsA, acp.data(), colsA, tau.data());
+
+         //r is the upper trapezoidal part of a on exit of geqrf:
+         r.resize(shapeR);
+         r = (T) 0.0;
+         for(size_t i = 0; i < nK; ++i)
+            for(size_t j = i; j < colsA; ++j)
+               r.data()[i*colsA + j] = acp.data()[i*colsA + j];
+
+         //Q is formed on the leading nK columns
+         orgqr(CblasRowMajor, rowsA, nK, nK, acp.data(), colsA, tau.data());
+
+         q.resize(shapeQ);
+         for(size_t i = 0; i < rowsA; ++i)
+            std::copy(acp.data()+i*colsA, acp.data()+i*colsA+nK, q.data()+i*nK);
+      }
+
+   /** perform a thin LQ decomposition, A = L * Q
+    * Unlike the in-place version, A need not be wide: with K = min(rows, cols), L has K columns and Q has K rows.
+    * @param a input tensor of order M, first N-1 indices are taken as rows
+    * @param l lower triangular (trapezoidal) tensor of order N, the last index has dimension K
+    * @param q tensor of order M-N+2 with orthonormal rows, the first index has dimension K
+    */
+   template<typename T, size_t M, size_t N>
+      void Gelqf (
+            const TArray<T, M>& a,
+            TArray<T, N>& l,
+            TArray<T, M-N+2>& q)
+      {
+         if(a.size() == 0) return;
+
+         const IVector<M>& shapeA = a.shape();
+
+         size_t rowsA = std::accumulate(shapeA.begin(), shapeA.begin()+N-1, 1ul, std::multiplies<size_t>());
+         size_t colsA = std::accumulate(shapeA.begin()+N-1, shapeA.end(), 1ul, std::multiplies<size_t>());
+
+         size_t nK = std::min(rowsA, colsA);
+
+         IVector<N> shapeL;
+         for(size_t i = 0; i < N-1; ++i) shapeL[i] = shapeA[i];
+         shapeL[N-1] = nK;
+
+         IVector<M-N+2> shapeQ;
+         shapeQ[0] = nK;
+         for(size_t i = 1; i < M-N+2; ++i) shapeQ[i] = shapeA[i+N-2];
+
+         TArray<T, M> acp(a);
+
+         std::vector<T> tau(nK);
+
+         gelqf(CblasRowMajor, rowsA, colsA, acp.data(), colsA, tau.data());
+
+         //L is the lower trapezoidal part of a on exit of gelqf:
+         l.resize(shapeL);
+         l = (T) 0.0;
+         for(size_t i = 0; i < rowsA; ++i)
+            for(size_t j = 0; j <= std::min(i, nK-1); ++j)
+               l.data()[i*nK + j] = acp.data()[i*colsA + j];
+
+         //Q is formed on the leading nK rows
+         orglq(CblasRowMajor, nK, colsA, nK, acp.data(), colsA, tau.data());
+
+         q.resize(shapeQ);
+         std::copy(acp.data(), acp.data()+nK*colsA, q.data());
+      }
+
+   /** perform a truncated SVD of matrix by randomized range-finder
+    * The range of A is sampled by Y = (A * A^H)^q * A * Omega with a gaussian test matrix Omega of (rank + n_over) columns,
+    * and the SVD is carried out on the projected matrix B = Q^H * A, where Q is an orthonormal basis of Y.
+    * Falls back to the thin SVD (all singular values are returned) if rank is 0 or not small enough compared to min(m, n).
+    * @param rank number of singular values and vectors returned
+    * @param n_over oversampling size of the test matrix
+    * @param n_iter number of power iterations, improves accuracy for slowly decaying singular values
+    * @return squared norm of A which is not represented by the returned singular values,
+    *         |A - Q Q^H A|^2 + sum_{i >= rank} S_B(i)^2, evaluated from the residual itself rather than by |A|^2 - sum S(i)^2
+    */
+   template<typename T>
+      typename remove_complex<T>::type Gesvd_random (
+            const TArray<T, 2>& a,
+            TArray<typename remove_complex<T>::type, 1>& s,
+            TArray<T, 2>& u,
+            TArray<T, 2>& vt,
+            const size_t& rank,
+            const size_t& n_over = 10,
+            const size_t& n_iter = 2)
+      {
+         typedef typename remove_complex<T>::type T_real;
+
+         if(a.size() == 0) return static_cast<T_real>(0);
+
+         size_t rowsA = a.shape(0);
+         size_t colsA = a.shape(1);
+
+         size_t nSingular = std::min(rowsA, colsA);
+
+         size_t nSample = std::min(rank + n_over, nSingular);
+
+         // no gain from sampling
+         if(rank == 0 || 2*nSample > nSingular) {
+            Gesvd('S', 'S', a, s, u, vt);
+            return static_cast<T_real>(0);
+         }
+
+         // gaussian test matrix, seeded by shape to be reproducible and thread-safe
+         std::mt19937 rgen(rowsA*colsA+nSample);
+         std::normal_distribution<T_real> dist;
+
+         TArray<T, 2> omega(colsA, nSample);
+         omega.generate([&] () { return static_cast<T>(dist(rgen)); });
+
+         // Y := A * Omega, then orthonormalized in place
+         TArray<T, 2> y;
+         TArray<T, 2> r;
+         Gemm(CblasNoTrans, CblasNoTrans, static_cast<T>(1), a, omega, static_cast<T>(0), y);
+         Geqrf(y, r);
+         omega.clear();
+
+         // power iterations: Z := A^H * Y, Y := A * Z with re-orthonormalization
+         for(size_t iter = 0; iter < n_iter; ++iter) {
+            TArray<T, 2> z;
+            Gemm(CblasConjTrans, CblasNoTrans, static_cast<T>(1), a, y, static_cast<T>(0), z);
+            Geqrf(z, r);
+            y.clear();
+            Gemm(CblasNoTrans, CblasNoTrans, static_cast<T>(1), a, z, static_cast<T>(0), y);
+            Geqrf(y, r);
+         }
+
+         // B := Y^H * A, and its SVD
+         TArray<T, 2> b;
+         Gemm(CblasConjTrans, CblasNoTrans, static_cast<T>(1), y, a, static_cast<T>(0), b);
+
+         TArray<T_real, 1> s_b;
+         TArray<T, 2> u_b;
+         TArray<T, 2> vt_b;
+         Gesvd('S', 'S', b, s_b, u_b, vt_b);
+
+         // residual out of the sampled range, R := A - Y * B
+         TArray<T, 2> res;
+         Copy(a, res);
+         Gemm(CblasNoTrans, CblasNoTrans, static_cast<T>(-1), y, b, static_cast<T>(1), res);
+         T_real rnorm = Nrm2(res);
+         T_real tail = rnorm * rnorm;
+         for(size_t i = rank; i < s_b.size(); ++i) tail += s_b.data()[i] * s_b.data()[i];
+         res.clear();
+         b.clear();
+
+         // keep leading rank singular values and vectors
+         s.resize(rank);
+         s = s_b.subarray(shape(0), shape(rank-1));
+
+         TArray<T, 2> u_k(nSample, rank);
+         u_k = u_b.subarray(shape(0, 0), shape(nSample-1, rank-1));
+
+         u.clear();
+         Gemm(CblasNoTrans, CblasNoTrans, static_cast<T>(1), y, u_k, static_cast<T>(0), u);
+
+         vt.resize(rank, colsA);
+         vt = vt_b.subarray(shape(0, 0), shape(rank-1, colsA-1));
+
+         return tail;
+      }
+
 } // namespace btas
 
 #endif // __BTAS_DENSE_TLAPACK_H
@@ -253,12 +253,13 @@ inline void QSDgesvd (
             QSDArray<K, Q>& u,
             QSDArray<N-K+2, Q>& vt,
       const int& DMAX = 0,
-      const double& DTOL = 1.0)
+      const double& DTOL = 1.0,
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
 {
    if(dir == LeftArrow)
-      Gesvd<double, N, K, Q, LeftArrow>(a, s, u, vt, DMAX, DTOL);
+      Gesvd<double, N, K, Q, LeftArrow>(a, s, u, vt, DMAX, DTOL, driver);
    else
-      Gesvd<double, N, K, Q, RightArrow>(a, s, u, vt, DMAX, DTOL);
+      Gesvd<double, N, K, Q, RightArrow>(a, s, u, vt, DMAX, DTOL, driver);
 }
 
 /// Gesvd
@@ -281,6 +282,80 @@ inline void QSDgesvd (
       Gesvd<double, N, K, Q, RightArrow>(a, s, s_rm, u, u_rm, vt, vt_rm, DMAX, DTOL);
 }
 
+/// Gesvd_us: returns U * S instead of U
+template<size_t N, size_t K, class Q>
+inline void QSDgesvd_us (
+      const BTAS_ARROW_DIRECTION& dir,
+      const QSDArray<N, Q>& a,
+             SDArray<1>& s,
+            QSDArray<K, Q>& us,
+            QSDArray<N-K+2, Q>& vt,
+      const int& DMAX = 0,
+      const double& DTOL = 1.0,
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   if(dir == LeftArrow)
+      Gesvd_us<double, N, K, Q, LeftArrow>(a, s, us, vt, DMAX, DTOL, driver);
+   else
+      Gesvd_us<double, N, K, Q, RightArrow>(a, s, us, vt, DMAX, DTOL, driver);
+}
+
+/// Gesvd_svt: returns S * V^T instead of V^T
+template<size_t N, size_t K, class Q>
+inline void QSDgesvd_svt (
+      const BTAS_ARROW_DIRECTION& dir,
+      const QSDArray<N, Q>& a,
+             SDArray<1>& s,
+            QSDArray<K, Q>& u,
+            QSDArray<N-K+2, Q>& svt,
+      const int& DMAX = 0,
+      const double& DTOL = 1.0,
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   if(dir == LeftArrow)
+      Gesvd_svt<double, N, K, Q, LeftArrow>(a, s, u, svt, DMAX, DTOL, driver);
+   else
+      Gesvd_svt<double, N, K, Q, RightArrow>(a, s, u, svt, DMAX, DTOL, driver);
+}
+
+/// Gesvd_random
+template<size_t N, size_t K, class Q>
+inline void QSDgesvd_random (
+      const BTAS_ARROW_DIRECTION& dir,
+      const QSDArray<N, Q>& a,
+             SDArray<1>& s,
+            QSDArray<K, Q>& u,
+            QSDArray<N-K+2, Q>& vt,
+      const int& DMAX,
+      const size_t& NOVER = 10,
+      const size_t& NITER = 2)
+{
+   if(dir == LeftArrow)
+      Gesvd_random<double, N, K, Q, LeftArrow>(a, s, u, vt, DMAX, NOVER, NITER);
+   else
+      Gesvd_random<double, N, K, Q, RightArrow>(a, s, u, vt, DMAX, NOVER, NITER);
+}
+
+/// Geqrf
+template<size_t N, size_t K, class Q>
+inline void QSDgeqrf (
+      const QSDArray<N, Q>& a,
+            QSDArray<K, Q>& q,
+            QSDArray<N-K+2, Q>& r)
+{
+   Geqrf<double, N, K, Q>(a, q, r);
+}
+
+/// Gelqf
+template<size_t N, size_t K, class Q>
+inline void QSDgelqf (
+      const QSDArray<N, Q>& a,
+            QSDArray<K, Q>& l,
+            QSDArray<N-K+2, Q>& q)
+{
+   Gelqf<double, N, K, Q>(a, l, q);
+}
+
 } // namespace btas
 
 #endif // __BTAS_QSPARSE_QSDARRAY_H
@@ -0,0 +1,66 @@
+#ifndef __BTAS_QSPARSE_QSDASYNC_H
+#define __BTAS_QSPARSE_QSDASYNC_H 1
+
+#include <future>
+
+#include <legacy/common/btas.h>
+#include <legacy/common/TVector.h>
+#include <legacy/common/ThreadPool.h>
+
+#include <legacy/QSPARSE/QSDArray.h>
+
+namespace btas
+{
+
+//  ====================================================================================================
+//  Asynchronous variants of QSDArray operations, which run on ThreadPool::shared()
+//
+//  Arrays are taken by reference, thus they must be alive until the future is ready,
+//  and outputs must not be touched in the meantime. Exceptions are re-thrown by future::get().
+//  Scalars and index vectors are captured by copy.
+//  ====================================================================================================
+
+/// Contract
+template<size_t M, size_t N, size_t K, class Q>
+std::future<void> QSDcontract_async (
+      const double& alpha,
+      const QSDArray<M, Q>& a, const IVector<K>& contractA,
+      const QSDArray<N, Q>& b, const IVector<K>& contractB,
+      const double& beta,
+            QSDArray<M+N-K-K, Q>& c)
+{
+   return ThreadPool::shared().submit([=, &a, &b, &c] () { QSDcontract(alpha, a, contractA, b, contractB, beta, c); });
+}
+
+/// Gemm
+template<size_t L, size_t M, size_t N, class Q>
+std::future<void> QSDgemm_async (
+      const CBLAS_TRANSPOSE& transa,
+      const CBLAS_TRANSPOSE& transb,
+      const double& alpha,
+      const QSDArray<L, Q>& a,
+      const QSDArray<M, Q>& b,
+      const double& beta,
+            QSDArray<N, Q>& c)
+{
+   return ThreadPool::shared().submit([=, &a, &b, &c] () { QSDgemm(transa, transb, alpha, a, b, beta, c); });
+}
+
+/// Gesvd
+template<size_t N, size_t K, class Q>
+std::future<void> QSDgesvd_async (
+      const BTAS_ARROW_DIRECTION& dir,
+      const QSDArray<N, Q>& a,
+             SDArray<1>& s,
+            QSDArray<K, Q>& u,
+            QSDArray<N-K+2, Q>& vt,
+      const int& DMAX = 0,
+      const double& DTOL = 1.0,
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   return ThreadPool::shared().submit([=, &a, &s, &u, &vt] () { QSDgesvd(dir, a, s, u, vt, DMAX, DTOL, driver); });
+}
+
+} // namespace btas
+
+#endif // __BTAS_QSPARSE_QSDASYNC_H
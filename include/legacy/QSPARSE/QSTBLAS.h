@@ -237,6 +237,92 @@ void Gemm (
 
 //  ====================================================================================================
 
+/// Diagonal matrix multiplication for QSTArray: (general matrix) x (diagonal matrix), a(..., j) *= b(j)
+/// Non-zero blocks are scaled in parallel, each of which by vectorised loop
+template<typename T, typename U, size_t N, class Q>
+void Dimm (const QSTArray<T, N, Q>& a, const STArray<U, 1>& b)
+{
+   QSTArray<T, N, Q>& x = const_cast<QSTArray<T, N, Q>&>(a);
+
+   size_t n = b.size();
+
+   // collecting blocks to be scaled
+   std::vector<std::pair<TArray<T, N>*, const TArray<U, 1>*>> task;
+   task.reserve(x.nnz());
+   for(auto aij = x.begin(); aij != x.end(); ++aij)
+   {
+      auto bjj = b.find(aij->first % n);
+
+      if(bjj != b.end())
+      {
+         BTAS_THROW(aij->second->shape(N-1) == bjj->second->size(), "Dimm(QSPARSE): b must have the same shape of column rank of a.");
+         task.push_back(std::make_pair(aij->second.get(), bjj->second.get()));
+      }
+   }
+
+   size_t ntask = task.size();
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t i = 0; i < ntask; ++i)
+   {
+      size_t colsA = task[i].second->size();
+      size_t rowsA = (colsA > 0) ? task[i].first->size() / colsA : 0;
+      for(size_t r = 0; r < rowsA; ++r)
+      {
+               T* __restrict ptrA = task[i].first->data() + r * colsA;
+         const U* __restrict ptrB = task[i].second->data();
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+         for(size_t c = 0; c < colsA; ++c) ptrA[c] *= ptrB[c];
+      }
+   }
+}
+
+/// Diagonal matrix multiplication for QSTArray: (diagonal matrix) x (general matrix), b(i, ...) *= a(i)
+/// Non-zero blocks are scaled in parallel, each of which by vectorised loop
+template<typename T, typename U, size_t N, class Q>
+void Dimm (const STArray<T, 1>& a, const QSTArray<U, N, Q>& b)
+{
+   QSTArray<U, N, Q>& y = const_cast<QSTArray<U, N, Q>&>(b);
+
+   size_t n = y.stride(0);
+
+   // collecting blocks to be scaled
+   std::vector<std::pair<const TArray<T, 1>*, TArray<U, N>*>> task;
+   task.reserve(y.nnz());
+   for(auto bij = y.begin(); bij != y.end(); ++bij)
+   {
+      auto aii = a.find(bij->first / n);
+
+      if(aii != a.end())
+      {
+         BTAS_THROW(aii->second->size() == bij->second->shape(0), "Dimm(QSPARSE): a must have the same shape of row rank of b.");
+         task.push_back(std::make_pair(aii->second.get(), bij->second.get()));
+      }
+   }
+
+   size_t ntask = task.size();
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t i = 0; i < ntask; ++i)
+   {
+      size_t rowsB = task[i].first->size();
+      size_t colsB = (rowsB > 0) ? task[i].second->size() / rowsB : 0;
+      for(size_t r = 0; r < rowsB; ++r)
+      {
+         const T f = task[i].first->data()[r];
+         U* __restrict ptrB = task[i].second->data() + r * colsB;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+         for(size_t c = 0; c < colsB; ++c) ptrB[c] *= f;
+      }
+   }
+}
+
 /// Normalization
 template<typename T, size_t N, class Q>
 void Normalize (QSTArray<T, N, Q>& x)
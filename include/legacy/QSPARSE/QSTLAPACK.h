@@ -25,11 +25,22 @@ enum BTAS_ARROW_DIRECTION
    RightArrow ///< V^T has the quantum number of A in SVD
 };
 
+/// Where singular values are absorbed in thin SVD
+/// Absorbing is done while expanding U or V^T from merged form, so that no extra pass over them is needed.
+enum BTAS_SVD_ABSORB
+{
+   AbsorbNone, ///< returns U and V^T
+
+   AbsorbU,    ///< returns U * S instead of U
+
+   AbsorbVt    ///< returns S * V^T instead of V^T
+};
+
 template<BTAS_ARROW_DIRECTION> struct __QST_Gesvd_thread_impl;
 
 template<> struct __QST_Gesvd_thread_impl<LeftArrow>
 {
-   template<typename T, class Q>
+   template<typename T, class Q, class Task>
    static void get_task (
       const char& jobu,
       const char& jobvt,
@@ -37,7 +48,8 @@ template<> struct __QST_Gesvd_thread_impl<LeftArrow>
             STArray<typename remove_complex<T>::type, 1>& s,
             QSTArray<T, 2, Q>& u,
             QSTArray<T, 2, Q>& vt,
-            std::vector<Gesvd_arguments<T, 2, 2>>& task)
+            std::vector<Task>& task,
+      const Task& proto)
    {
       task.reserve(a.nnz());
 
@@ -55,14 +67,15 @@ template<> struct __QST_Gesvd_thread_impl<LeftArrow>
          size_t uii = iRow*rowsA+iRow;
          size_t vij = iRow*colsA+jCol;
 
-         task.push_back(Gesvd_arguments<T, 2, 2>(jobu, jobvt, aij->second, s.reserve(sii)->second, u.reserve(uii)->second, vt.reserve(vij)->second));
+         task.push_back(proto);
+         task.back().reset(jobu, jobvt, aij->second, s.reserve(sii)->second, u.reserve(uii)->second, vt.reserve(vij)->second);
       }
    }
 };
 
 template<> struct __QST_Gesvd_thread_impl<RightArrow>
 {
-   template<typename T, class Q>
+   template<typename T, class Q, class Task>
    static void get_task (
       const char& jobu,
       const char& jobvt,
@@ -70,7 +83,8 @@ template<> struct __QST_Gesvd_thread_impl<RightArrow>
             STArray<typename remove_complex<T>::type, 1>& s,
             QSTArray<T, 2, Q>& u,
             QSTArray<T, 2, Q>& vt,
-            std::vector<Gesvd_arguments<T, 2, 2>>& task)
+            std::vector<Task>& task,
+      const Task& proto)
    {
       task.reserve(a.nnz());
 
@@ -88,45 +102,163 @@ template<> struct __QST_Gesvd_thread_impl<RightArrow>
          size_t uij = iRow*colsA+jCol;
          size_t vjj = jCol*colsA+jCol;
 
-         task.push_back(Gesvd_arguments<T, 2, 2>(jobu, jobvt, aij->second, s.reserve(sjj)->second, u.reserve(uij)->second, vt.reserve(vjj)->second));
+         task.push_back(proto);
+         task.back().reset(jobu, jobvt, aij->second, s.reserve(sjj)->second, u.reserve(uij)->second, vt.reserve(vjj)->second);
       }
    }
 };
 
 /// Singular value decomposition (SVD) for QSTArray
 /// This is only for 'merged' matrix
-template<typename T, class Q, BTAS_ARROW_DIRECTION ArrowDir>
+/// \param proto prototype of task arguments for each block, which selects the SVD kernel
+template<typename T, class Q, BTAS_ARROW_DIRECTION ArrowDir, class Task>
 void QST_Gesvd_thread (
       const char& jobu,
       const char& jobvt,
       const QSTArray<T, 2, Q>& a,
             STArray<typename remove_complex<T>::type, 1>& s,
             QSTArray<T, 2, Q>& u,
-            QSTArray<T, 2, Q>& vt)
+            QSTArray<T, 2, Q>& vt,
+      const Task& proto)
 {
-   std::vector<Gesvd_arguments<T, 2, 2>> task;
+   std::vector<Task> task;
 
-   __QST_Gesvd_thread_impl<ArrowDir>::get_task(jobu, jobvt, a, s, u, vt, task);
+   __QST_Gesvd_thread_impl<ArrowDir>::get_task(jobu, jobvt, a, s, u, vt, task, proto);
 
    parallel_call(task);
 }
 
-/// Thin Singular Value Decomposition
-///
+/// Singular value decomposition (SVD) for QSTArray
+/// This is only for 'merged' matrix
+/// LAPACK driver is selected for each block by lapack_driver_policy unless specified
+template<typename T, class Q, BTAS_ARROW_DIRECTION ArrowDir>
+void QST_Gesvd_thread (
+      const char& jobu,
+      const char& jobvt,
+      const QSTArray<T, 2, Q>& a,
+            STArray<typename remove_complex<T>::type, 1>& s,
+            QSTArray<T, 2, Q>& u,
+            QSTArray<T, 2, Q>& vt,
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   QST_Gesvd_thread<T, Q, ArrowDir>(jobu, jobvt, a, s, u, vt, Gesvd_arguments<T, 2, 2>(driver));
+}
+
+/// SVD task for merged block, which is referred without copy
+/// The merged block is packed into dense matrix just before the decomposition, and released after that,
+/// so that only blocks being decomposed are held in memory.
+template<typename T, class Task>
+struct __QST_Gesvd_packed_task : public Task
+{
+   const QSTmergeBlock<T>* block_;
+
+   __QST_Gesvd_packed_task (const Task& proto, const QSTmergeBlock<T>* block) : Task (proto), block_ (block) { }
+
+   void call () const
+   {
+      TArray<T, 2>& a = *get<0>(*this);
+      a.resize(block_->rows, block_->cols);
+      block_->pack(a.data());
+      Task::call();
+      a.clear();
+   }
+
+   /// Whether less accurate Gram matrix SVD was used
+   bool gram_used () const { return false; }
+
+   /// Decompose again by full SVD
+   void redo () { call(); }
+};
+
+/// SVD task for merged block, specialized for LAPACK SVD kernel
+/// The merged block is packed straight into the LAPACK input buffer.
+template<typename T>
+struct __QST_Gesvd_packed_task<T, Gesvd_arguments<T, 2, 2>> : public Gesvd_arguments<T, 2, 2>
+{
+   const QSTmergeBlock<T>* block_;
+
+   /// Whether Gram matrix SVD was used, which is accepted regardless of conditioning here
+   mutable bool gram_;
+
+   __QST_Gesvd_packed_task (const Gesvd_arguments<T, 2, 2>& proto, const QSTmergeBlock<T>* block) : Gesvd_arguments<T, 2, 2> (proto), block_ (block), gram_ (false) { }
+
+   void call () const
+   {
+      size_t rowsA = block_->rows;
+      size_t colsA = block_->cols;
+      size_t nSingular = std::min(rowsA, colsA);
+
+      size_t colsU  = (this->jobu_  == 'A') ? rowsA : nSingular;
+      size_t rowsVt = (this->jobvt_ == 'A') ? colsA : nSingular;
+
+      std::vector<T> work(rowsA*colsA);
+      block_->pack(work.data());
+
+      TArray<typename remove_complex<T>::type, 1>& s = *get<1>(*this);
+      TArray<T, 2>& u  = *get<2>(*this);
+      TArray<T, 2>& vt = *get<3>(*this);
+
+      s.resize(nSingular);
+      u.resize(rowsA, colsU);
+      vt.resize(rowsVt, colsA);
+
+      gram_ = false;
+      if(this->driver_ == SvdGram) {
+         gram_ = gesvd_gram(CblasRowMajor, this->jobu_, this->jobvt_, rowsA, colsA, work.data(), colsA, s.data(), u.data(), colsU, vt.data(), colsA,
+                            static_cast<typename remove_complex<T>::type>(0));
+         if(gram_) return;
+      }
+
+      gesvd((this->driver_ == SvdGram) ? SvdAuto : this->driver_, CblasRowMajor, this->jobu_, this->jobvt_, rowsA, colsA, work.data(), colsA, s.data(), u.data(), colsU, vt.data(), colsA);
+   }
+
+   /// Whether less accurate Gram matrix SVD was used
+   bool gram_used () const { return gram_; }
+
+   /// All singular values are computed
+   typename remove_complex<T>::type tail () const { return 0; }
+
+   /// Decompose again by full SVD
+   void redo () { if(this->driver_ == SvdGram) this->driver_ = SvdAuto; call(); }
+};
+
+/// Cutoff of singular values for truncation
 /// If DMAX = 0, all non-zero singular values (>= 1.0e-16) are kept
 /// If DMAX > 0, only DMAX number of singular values are kept
 /// If DMAX < 0, discards singular values less than DTOL x 10^(DMAX)
-///
-/// Returns total discarded norm (or density weights): sum_{i > DMAX} S(i)^2
-template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir = LeftArrow>
+template<typename T_real>
+T_real __QST_Gesvd_cutoff (const STArray<T_real, 1>& s_value, const int& DMAX, const T_real& DTOL)
+{
+  // Collect singular values
+  std::vector<T_real> s_sorted;
+  for(auto its = s_value.begin(); its != s_value.end(); ++its)
+    s_sorted.insert(s_sorted.end(), its->second->begin(), its->second->end());
+  // Sort descending order
+  std::sort(s_sorted.rbegin(), s_sorted.rend());
+  // Calc. cutoff tolerance
+  T_real cutoff = 1.0e-16;
+  if(DMAX > 0 && DMAX < s_sorted.size())
+    cutoff = s_sorted[DMAX-1];
+  if(DMAX < 0)
+    cutoff = fabs(DTOL) * pow(10.0, DMAX);
+  return cutoff;
+}
+
+/// Thin SVD, which is carried out by SVD kernel of task prototype for each merged block
+/// The kernel may not return all singular values, then the squared norm which they don't represent is given by tail() of task,
+/// and is added to discarded norm
+/// Singular values are absorbed into U or V^T according to absorb
+template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir, class Task>
 typename remove_complex<T>::type
-Gesvd (
+__QST_Gesvd_thin_impl (
       const QSTArray<T, N, Q>& a,
             STArray<typename remove_complex<T>::type, 1>& s,
             QSTArray<T, K, Q>& u,
             QSTArray<T, N-K+2, Q>& vt,
-      const int& DMAX = 0,
-      const typename remove_complex<T>::type& DTOL = static_cast<typename remove_complex<T>::type>(1))
+      const int& DMAX,
+      const typename remove_complex<T>::type& DTOL,
+      const Task& proto,
+      const BTAS_SVD_ABSORB& absorb = AbsorbNone)
 {
    typedef typename remove_complex<T>::type T_real;
 
@@ -154,11 +286,13 @@ Gesvd (
       a_dshape_right[i] = a_dshape[i+L];
    }
 
-   // Merge array A into matrix form
-   QSTmergeInfo<L, Q> a_qinfo_left (a_qshape_left,  a_dshape_left );
-   QSTmergeInfo<R, Q> a_qinfo_right(a_qshape_right, a_dshape_right);
+   // Merge array A into matrix form, blocks of A are referred without copy
+   shared_ptr<const QSTmergeInfo<L, Q>> a_pinfo_left  = QSTmergeInfo<L, Q>::intern(a_qshape_left,  a_dshape_left );
+   shared_ptr<const QSTmergeInfo<R, Q>> a_pinfo_right = QSTmergeInfo<R, Q>::intern(a_qshape_right, a_dshape_right);
+   const QSTmergeInfo<L, Q>& a_qinfo_left  = *a_pinfo_left;
+   const QSTmergeInfo<R, Q>& a_qinfo_right = *a_pinfo_right;
 
-   QSTArray<T, 2, Q>  a_merge;
+   std::map<int, QSTmergeBlock<T>> a_merge;
    QSTmerge(a_qinfo_left, a, a_qinfo_right, a_merge);
 
    // Determine arrow direction
@@ -188,30 +322,61 @@ Gesvd (
    QSTArray<T, 2, Q> u_merge ( u_q_total, make_array( q_rows,-q_sval));
    QSTArray<T, 2, Q> vt_merge(vt_q_total, make_array( q_sval, q_cols));
 
-   QST_Gesvd_thread<T, Q, ArrowDir>('S', 'S', a_merge, s_value, u_merge, vt_merge);
+   int n_rows = q_rows.size();
+   int n_cols = q_cols.size();
+
+   // Pack and decompose each merged block in parallel
+   std::vector<__QST_Gesvd_packed_task<T, Task>> task;
+   task.reserve(a_merge.size());
+   for(auto it = a_merge.begin(); it != a_merge.end(); ++it) {
+     int iRow = it->first / n_cols;
+     int jCol = it->first % n_cols;
+     // if compiler is clever, this 'if' is optimized for each arrow direction
+     int sTag = (ArrowDir == LeftArrow) ? iRow : jCol;
+     int uTag = (ArrowDir == LeftArrow) ? iRow*n_rows+iRow : iRow*n_cols+jCol;
+     int vTag = (ArrowDir == LeftArrow) ? iRow*n_cols+jCol : jCol*n_cols+jCol;
+     task.push_back(__QST_Gesvd_packed_task<T, Task>(proto, &it->second));
+     task.back().reset('S', 'S', shared_ptr<TArray<T, 2>>(new TArray<T, 2>()),
+                       s_value.reserve(sTag)->second, u_merge.reserve(uTag)->second, vt_merge.reserve(vTag)->second);
+     task.back().FLOPS_ = it->second.rows * it->second.cols;
+   }
+
+   parallel_call(task);
+
+  // Calc. cutoff tolerance
+  T_real cutoff = __QST_Gesvd_cutoff(s_value, DMAX, DTOL);
+
+  // Gram matrix SVD loses accuracy for small singular values,
+  // blocks of which the smallest kept singular value is too small are decomposed again by full SVD
+  bool redone = false;
+  for(size_t i = 0; i < task.size(); ++i) {
+    if(!task[i].gram_used()) continue;
+    const TArray<T_real, 1>& sv = *get<1>(task[i]);
+    if(sv.size() == 0) continue;
+    T_real s_kept = sv.data()[0];
+    for(auto itd = sv.begin(); itd != sv.end() && *itd >= cutoff; ++itd) s_kept = *itd;
+    if(s_kept < lapack_driver_policy::gram_svd_tolerance() * sv.data()[0]) {
+      task[i].redo();
+      redone = true;
+    }
+  }
+  if(redone) cutoff = __QST_Gesvd_cutoff(s_value, DMAX, DTOL);
+
+  // Norm of singular values which were not computed
+  T_real tnorm = 0.0;
+  for(size_t i = 0; i < task.size(); ++i) tnorm += task[i].tail();
+
+   task.clear();
    a_merge.clear();
 
   // Truncate by singular values
   // Dicarded norm: dnorm = sum_{i > D} s_value[i]^2
   T_real dnorm = 0.0;
   int n_sval = q_sval.size();
-  int n_cols = q_cols.size();
   // Containers of selected quantum number indices and sizes
   Qshapes<Q> q_sval_nz; q_sval_nz.reserve(n_sval);
   Dshapes    d_sval_nz; d_sval_nz.reserve(n_sval);
   std::map<int, int> map_sval_nz;
-  // Collect singular values
-  std::vector<T_real> s_sorted;
-  for(auto its = s_value.begin(); its != s_value.end(); ++its)
-    s_sorted.insert(s_sorted.end(), its->second->begin(), its->second->end());
-  // Sort descending order
-  std::sort(s_sorted.rbegin(), s_sorted.rend());
-  // Calc. cutoff tolerance
-  T_real cutoff = 1.0e-16;
-  if(DMAX > 0 && DMAX < s_sorted.size())
-    cutoff = s_sorted[DMAX-1];
-  if(DMAX < 0)
-    cutoff = fabs(DTOL) * pow(10.0, DMAX);
   // Select singular values
   int nnz = 0;
   for(auto its = s_value.begin(); its != s_value.end(); ++its) {
@@ -243,50 +408,235 @@ Gesvd (
   }
   s_value_nz.check_dshape();
   s_value.clear();
-  // Copy selected left-singular vectors
-  QSTArray<T, 2, Q> u_merge_nz(u_merge.q(), make_array( q_rows,-q_sval_nz));
-  for(auto it = u_merge.begin(); it != u_merge.end(); ++it) {
-    int irow = it->first / n_sval;
-    int icol = it->first % n_sval;
-    auto imap = map_sval_nz.find(icol);
-    if(imap != map_sval_nz.end()) {
-      auto jt = u_merge_nz.reserve(irow * nnz + imap->second);
-      assert(jt != u_merge_nz.end()); // if aborted here, there's a bug in btas::QSDgesvd
-      int Ds = d_sval_nz[imap->second];
-      int Dr = it->second->shape(0);
-      jt->second->resize(Dr, Ds);
-      *jt->second = it->second->subarray(shape(0, 0), shape(Dr-1, Ds-1));
-    }
-  }
-  u_merge_nz.check_dshape();
-  u_merge.clear();
-  // Copy selected right-singular vectors
-  QSTArray<T, 2, Q> vt_merge_nz(vt_merge.q(), make_array( q_sval_nz, q_cols));
-  for(auto it = vt_merge.begin(); it != vt_merge.end(); ++it) {
-    int irow = it->first / n_cols;
-    int icol = it->first % n_cols;
-    auto imap = map_sval_nz.find(irow);
-    if(imap != map_sval_nz.end()) {
-      auto jt = vt_merge_nz.reserve(imap->second * n_cols + icol);
-      assert(jt != vt_merge_nz.end()); // if aborted here, there's a bug in btas::QSDgesvd
-      int Ds = d_sval_nz[imap->second];
-      int Dc = it->second->shape(1);
-      jt->second->resize(Ds, Dc);
-      *jt->second = it->second->subarray(shape(0, 0), shape(Ds-1, Dc-1));
-    }
-  }
-  vt_merge_nz.check_dshape();
-  vt_merge.clear();
+  // Discarded norm includes singular values which were not computed
+  dnorm += tnorm;
+
+  // Truncate and reshape to array form, directly from the output of SVD
+  QSTselectInfo<Q> u_select;
+  u_select.qshape =-q_sval_nz;
+  u_select.dshape = d_sval_nz;
+  u_select.index  = map_sval_nz;
+
+  QSTselectInfo<Q> vt_select;
+  vt_select.qshape = q_sval_nz;
+  vt_select.dshape = d_sval_nz;
+  vt_select.index  = map_sval_nz;
 
-  // Reshape matrix to array form
   Copy  (s_value_nz, s);
-  QSTexpand(a_qinfo_left, u_merge_nz, u);
-  QSTexpand(vt_merge_nz, a_qinfo_right, vt);
+  QSTexpand(a_qinfo_left, u_merge, u_select, u, (absorb == AbsorbU) ? &s_value_nz : 0);
+  QSTexpand(vt_select, vt_merge, a_qinfo_right, vt, (absorb == AbsorbVt) ? &s_value_nz : 0);
 
   return dnorm;
 
 }
 
+/// Thin Singular Value Decomposition
+///
+/// If DMAX = 0, all non-zero singular values (>= 1.0e-16) are kept
+/// If DMAX > 0, only DMAX number of singular values are kept
+/// If DMAX < 0, discards singular values less than DTOL x 10^(DMAX)
+///
+/// SVD of each merged block is done by driver. With SvdGram, strongly rectangular blocks are decomposed through
+/// their Gram matrices, and decomposed again by full SVD if the smallest kept singular value is less than
+/// lapack_driver_policy::gram_svd_tolerance() of the largest one.
+///
+/// Returns total discarded norm (or density weights): sum_{i > DMAX} S(i)^2
+template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir = LeftArrow>
+typename remove_complex<T>::type
+Gesvd (
+      const QSTArray<T, N, Q>& a,
+            STArray<typename remove_complex<T>::type, 1>& s,
+            QSTArray<T, K, Q>& u,
+            QSTArray<T, N-K+2, Q>& vt,
+      const int& DMAX = 0,
+      const typename remove_complex<T>::type& DTOL = static_cast<typename remove_complex<T>::type>(1),
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   return __QST_Gesvd_thin_impl<T, N, K, Q, ArrowDir>(a, s, u, vt, DMAX, DTOL, Gesvd_arguments<T, 2, 2>(driver));
+}
+
+/// Thin SVD which returns U * S instead of U, i.e. A = (U * S) * V^T
+/// Truncation and returned value are the same as Gesvd
+template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir = LeftArrow>
+typename remove_complex<T>::type
+Gesvd_us (
+      const QSTArray<T, N, Q>& a,
+            STArray<typename remove_complex<T>::type, 1>& s,
+            QSTArray<T, K, Q>& us,
+            QSTArray<T, N-K+2, Q>& vt,
+      const int& DMAX = 0,
+      const typename remove_complex<T>::type& DTOL = static_cast<typename remove_complex<T>::type>(1),
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   return __QST_Gesvd_thin_impl<T, N, K, Q, ArrowDir>(a, s, us, vt, DMAX, DTOL, Gesvd_arguments<T, 2, 2>(driver), AbsorbU);
+}
+
+/// Thin SVD which returns S * V^T instead of V^T, i.e. A = U * (S * V^T)
+/// Truncation and returned value are the same as Gesvd
+template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir = LeftArrow>
+typename remove_complex<T>::type
+Gesvd_svt (
+      const QSTArray<T, N, Q>& a,
+            STArray<typename remove_complex<T>::type, 1>& s,
+            QSTArray<T, K, Q>& u,
+            QSTArray<T, N-K+2, Q>& svt,
+      const int& DMAX = 0,
+      const typename remove_complex<T>::type& DTOL = static_cast<typename remove_complex<T>::type>(1),
+      const BTAS_SVD_DRIVER& driver = SvdAuto)
+{
+   return __QST_Gesvd_thin_impl<T, N, K, Q, ArrowDir>(a, s, u, svt, DMAX, DTOL, Gesvd_arguments<T, 2, 2>(driver), AbsorbVt);
+}
+
+/// Truncated Singular Value Decomposition by randomized range-finder
+///
+/// Since at most DMAX singular values are kept in total, only DMAX leading singular values are computed for each merged block,
+/// from (DMAX + NOVER) random samples of its range with NITER power iterations (see Gesvd_random for dense array).
+/// Blocks which are not large enough compared to DMAX are decomposed by thin SVD.
+/// If DMAX <= 0, this is the same as thin SVD
+///
+/// Returns total discarded norm (or density weights): sum_{i > DMAX} S(i)^2, where singular values not computed are accounted
+/// by the residual out of the sampled range, |A - Q Q^H A|^2, rather than by |A|^2 - sum_{i <= DMAX} S(i)^2 to keep precision
+template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir = LeftArrow>
+typename remove_complex<T>::type
+Gesvd_random (
+      const QSTArray<T, N, Q>& a,
+            STArray<typename remove_complex<T>::type, 1>& s,
+            QSTArray<T, K, Q>& u,
+            QSTArray<T, N-K+2, Q>& vt,
+      const int& DMAX,
+      const size_t& NOVER = 10,
+      const size_t& NITER = 2)
+{
+   if(DMAX <= 0)
+      return Gesvd<T, N, K, Q, ArrowDir>(a, s, u, vt, DMAX);
+
+   return __QST_Gesvd_thin_impl<T, N, K, Q, ArrowDir>(a, s, u, vt, DMAX, 1.0, Gesvd_random_arguments<T>(DMAX, NOVER, NITER));
+}
+
+/// QR (LQ) decomposition for merged blocks, A = X * Y
+/// With LeftArrow, X is orthonormal (QR) and has zero quantum number, while Y has the quantum number of A.
+/// With RightArrow, Y is orthonormal (LQ) and has zero quantum number, while X has the quantum number of A.
+/// The inner index is spanned by rows (LeftArrow) or cols (RightArrow) of non-zero blocks, and no truncation is made.
+template<typename T, size_t N, size_t K, class Q, BTAS_ARROW_DIRECTION ArrowDir, class Task>
+void __QST_Geqrf_impl (
+      const QSTArray<T, N, Q>& a,
+            QSTArray<T, K, Q>& x,
+            QSTArray<T, N-K+2, Q>& y)
+{
+   const size_t L = K-1;
+   const size_t R = N-L;
+
+   const TVector<Qshapes<Q>, N>& a_qshape = a.qshape();
+   const TVector<Dshapes,    N>& a_dshape = a.dshape();
+
+   // Calc. row (left) shapes
+   TVector<Qshapes<Q>, L> a_qshape_left;
+   TVector<Dshapes,    L> a_dshape_left;
+
+   for(int i = 0; i < L; ++i) {
+      a_qshape_left [i] = a_qshape[i];
+      a_dshape_left [i] = a_dshape[i];
+   }
+
+   // Calc. col (right) shapes
+   TVector<Qshapes<Q>, R> a_qshape_right;
+   TVector<Dshapes,    R> a_dshape_right;
+
+   for(int i = 0; i < R; ++i) {
+      a_qshape_right[i] = a_qshape[i+L];
+      a_dshape_right[i] = a_dshape[i+L];
+   }
+
+   // Merge array A into matrix form
+   shared_ptr<const QSTmergeInfo<L, Q>> a_pinfo_left  = QSTmergeInfo<L, Q>::intern(a_qshape_left,  a_dshape_left );
+   shared_ptr<const QSTmergeInfo<R, Q>> a_pinfo_right = QSTmergeInfo<R, Q>::intern(a_qshape_right, a_dshape_right);
+   const QSTmergeInfo<L, Q>& a_qinfo_left  = *a_pinfo_left;
+   const QSTmergeInfo<R, Q>& a_qinfo_right = *a_pinfo_right;
+
+   QSTArray<T, 2, Q>  a_merge;
+   QSTmerge(a_qinfo_left, a, a_qinfo_right, a_merge);
+
+   Qshapes<Q> q_rows(a_qinfo_left.qshape_merged());
+   Qshapes<Q> q_cols(a_qinfo_right.qshape_merged());
+
+   int n_cols = q_cols.size();
+
+   // Collect inner indices from non-zero blocks, in order of rows (LeftArrow) or cols (RightArrow)
+   std::map<int, int> map_inner;
+   for(auto it = a_merge.begin(); it != a_merge.end(); ++it) {
+      if(it->second->size() == 0) continue;
+      int irow = it->first / n_cols;
+      int icol = it->first % n_cols;
+      map_inner.insert(std::make_pair((ArrowDir == LeftArrow) ? irow : icol, 0));
+   }
+   Qshapes<Q> q_inner; q_inner.reserve(map_inner.size());
+   for(auto imap = map_inner.begin(); imap != map_inner.end(); ++imap) {
+      imap->second = q_inner.size();
+      if(ArrowDir == LeftArrow)
+         q_inner.push_back( q_rows[imap->first]);
+      else
+         q_inner.push_back(-q_cols[imap->first]);
+   }
+   int n_inner = q_inner.size();
+
+   Q x_q_total = (ArrowDir == LeftArrow) ? Q::zero() : a.q();
+   Q y_q_total = (ArrowDir == LeftArrow) ? a.q() : Q::zero();
+
+   QSTArray<T, 2, Q> x_merge(x_q_total, make_array( q_rows,-q_inner));
+   QSTArray<T, 2, Q> y_merge(y_q_total, make_array( q_inner, q_cols));
+
+   // Decompose each block in parallel
+   std::vector<Task> task;
+   task.reserve(a_merge.nnz());
+   for(auto it = a_merge.begin(); it != a_merge.end(); ++it) {
+      if(it->second->size() == 0) continue;
+      int irow = it->first / n_cols;
+      int icol = it->first % n_cols;
+      int k = map_inner[(ArrowDir == LeftArrow) ? irow : icol];
+      auto xt = x_merge.reserve(irow * n_inner + k);
+      auto yt = y_merge.reserve(k * n_cols + icol);
+      assert(xt != x_merge.end() && yt != y_merge.end()); // if aborted here, there's a bug in btas::Geqrf
+      task.push_back(Task(it->second, xt->second, yt->second));
+   }
+
+   parallel_call(task);
+   a_merge.clear();
+
+   x_merge.check_dshape();
+   y_merge.check_dshape();
+
+   // Reshape matrix to array form
+   QSTexpand(a_qinfo_left, x_merge, x);
+   QSTexpand(y_merge, a_qinfo_right, y);
+}
+
+/// QR decomposition, A = Q * R
+///
+/// Merged blocks are decomposed in parallel without truncation,
+/// Q has zero quantum number and R has the quantum number of A, as U and V^T of Gesvd with LeftArrow.
+/// This is much cheaper than SVD for canonicalizing MPS when no truncation is needed.
+template<typename T, size_t N, size_t K, class Q>
+void Geqrf (
+      const QSTArray<T, N, Q>& a,
+            QSTArray<T, K, Q>& q,
+            QSTArray<T, N-K+2, Q>& r)
+{
+   __QST_Geqrf_impl<T, N, K, Q, LeftArrow, Geqrf_arguments<T, 2, 2>>(a, q, r);
+}
+
+/// LQ decomposition, A = L * Q
+///
+/// Merged blocks are decomposed in parallel without truncation,
+/// Q has zero quantum number and L has the quantum number of A, as V^T and U of Gesvd with RightArrow.
+template<typename T, size_t N, size_t K, class Q>
+void Gelqf (
+      const QSTArray<T, N, Q>& a,
+            QSTArray<T, K, Q>& l,
+            QSTArray<T, N-K+2, Q>& q)
+{
+   __QST_Geqrf_impl<T, N, K, Q, RightArrow, Gelqf_arguments<T, 2, 2>>(a, l, q);
+}
+
 /// Full Singular Value Decomposition
 ///
 /// \param s_rm removed singular values
@@ -332,8 +682,10 @@ Gesvd (
       a_dshape_right[i] = a_dshape[i+L];
    }
    // Merge array A into matrix form
-   QSTmergeInfo<L, Q> a_qinfo_left (a_qshape_left,  a_dshape_left );
-   QSTmergeInfo<R, Q> a_qinfo_right(a_qshape_right, a_dshape_right);
+   shared_ptr<const QSTmergeInfo<L, Q>> a_pinfo_left  = QSTmergeInfo<L, Q>::intern(a_qshape_left,  a_dshape_left );
+   shared_ptr<const QSTmergeInfo<R, Q>> a_pinfo_right = QSTmergeInfo<R, Q>::intern(a_qshape_right, a_dshape_right);
+   const QSTmergeInfo<L, Q>& a_qinfo_left  = *a_pinfo_left;
+   const QSTmergeInfo<R, Q>& a_qinfo_right = *a_pinfo_right;
    QSTArray<T, 2, Q>  a_merge;
    QSTmerge(a_qinfo_left, a, a_qinfo_right, a_merge);
    // Determine arrow direction
@@ -0,0 +1,112 @@
+#ifndef __BTAS_QSPARSE_QSTCOMM_H
+#define __BTAS_QSPARSE_QSTCOMM_H 1
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <boost/mpi.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <legacy/common/btas.h>
+#include <legacy/common/TVector.h>
+
+#include <legacy/QSPARSE/QSTArray.h>
+
+namespace btas
+{
+
+//  ====================================================================================================
+//  Distributed operations of quantum number-based block-sparse array over boost::mpi communicator
+//
+//  An index is distributed by its quantum-number blocks, in round-robin: block k belongs to rank k % nproc.
+//  Slices are references, thus distributing an array doesn't copy its elements.
+//  ====================================================================================================
+
+//! Return slice of x along index i, which consists of quantum-number blocks owned by rank
+/*! Quantum numbers of the index are kept in the same order, so that a contraction over the index
+ *  between slices of two arrays gives partial sum over the blocks owned by rank.
+ */
+template<typename T, size_t N, class Q>
+QSTArray<T, N, Q> QSTslice (const QSTArray<T, N, Q>& x, int i, int rank, int nproc)
+{
+   BTAS_THROW(i >= 0 && i < N, "btas::QSTslice: index is out of range");
+   TVector<Dshapes, N> indxs;
+   for(int j = 0; j < N; ++j) {
+      int nq = x.qshape(j).size();
+      if(j == i) {
+         for(int k = rank; k < nq; k += nproc) indxs[j].push_back(k);
+      }
+      else {
+         indxs[j].resize(nq);
+         for(int k = 0; k < nq; ++k) indxs[j][k] = k;
+      }
+   }
+   return x.subarray(indxs);
+}
+
+//! Sum x over all ranks of comm, and store the result on every rank
+/*! Non-zero blocks of the result are the union of those of x's.
+ *  Array shape is taken from the lowest rank which has it, so that a rank which contributes nothing may pass an empty array.
+ *  Block payloads are packed into one buffer, reduced to rank 0, and broadcasted,
+ *  therefore the result is identical, bit by bit, on every rank.
+ */
+template<typename T, size_t N, class Q>
+void QSTallreduce (const boost::mpi::communicator& comm, QSTArray<T, N, Q>& x)
+{
+   if(comm.size() == 1) return;
+
+   // shape
+   int root = boost::mpi::all_reduce(comm, (x.size() > 0) ? comm.rank() : comm.size(), boost::mpi::minimum<int>());
+   if(root == comm.size()) return;
+   if(boost::mpi::all_reduce(comm, (x.size() == 0) ? 1 : 0, std::plus<int>()) > 0) {
+      QSTArray<T, N, Q> header;
+      if(comm.rank() == root) header.resize(x.q(), x.qshape(), x.dshape(), false);
+      boost::mpi::broadcast(comm, header, root);
+      if(x.size() == 0) x.resize(header.q(), header.qshape(), header.dshape(), false);
+   }
+
+   // union of non-zero blocks
+   std::vector<int> tags;
+   tags.reserve(x.nnz());
+   for(auto it = x.begin(); it != x.end(); ++it) tags.push_back(it->first);
+   std::vector<std::vector<int>> all_tags;
+   boost::mpi::all_gather(comm, tags, all_tags);
+   tags.clear();
+   for(int p = 0; p < all_tags.size(); ++p) tags.insert(tags.end(), all_tags[p].begin(), all_tags[p].end());
+   std::sort(tags.begin(), tags.end());
+   tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+
+   // allocation is done serially, since it modifies std::map
+   std::vector<T*> x_ptrs(tags.size());
+   std::vector<size_t> offset(tags.size()+1, 0);
+   for(int t = 0; t < tags.size(); ++t) {
+      auto ib = x.reserve(tags[t]);
+      x_ptrs[t] = ib->second->data();
+      offset[t+1] = offset[t] + ib->second->size();
+   }
+   const size_t n = offset.back();
+   BTAS_THROW(n <= static_cast<size_t>(std::numeric_limits<int>::max()), "btas::QSTallreduce: payload is too large");
+
+   std::vector<T> sbuf(n);
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(int t = 0; t < tags.size(); ++t)
+      std::copy(x_ptrs[t], x_ptrs[t]+(offset[t+1]-offset[t]), sbuf.data()+offset[t]);
+
+   std::vector<T> rbuf(n);
+   boost::mpi::reduce(comm, sbuf.data(), n, rbuf.data(), std::plus<T>(), 0);
+   boost::mpi::broadcast(comm, rbuf.data(), n, 0);
+
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(int t = 0; t < tags.size(); ++t)
+      std::copy(rbuf.data()+offset[t], rbuf.data()+offset[t+1], x_ptrs[t]);
+}
+
+}; // namespace btas
+
+#endif // __BTAS_QSPARSE_QSTCOMM_H
@@ -0,0 +1,344 @@
+#ifndef __BTAS_QSPARSE_QSTDAVIDSON_H
+#define __BTAS_QSPARSE_QSTDAVIDSON_H 1
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+
+#include <boost/function.hpp>
+
+#include <legacy/common/numeric_traits.h>
+
+#include <legacy/QSPARSE/QSTArray.h>
+#include <legacy/QSPARSE/QSTBLAS.h>
+#include <legacy/QSPARSE/QSTLAPACK.h>
+#include <legacy/QSPARSE/QSTfused.h>
+
+namespace btas
+{
+
+//! Subspace expansion of QSTdavidson
+enum BTAS_SUBSPACE_EXPANSION
+{
+   DavidsonExpansion, ///< residuals are preconditioned by diagonal elements
+
+   LanczosExpansion   ///< residuals are used as they are, which spans block Krylov subspace
+};
+
+//! Complex conjugate, which keeps real type as it is
+template<typename T>
+inline T __QST_davidson_conj (const T& x) { return x; }
+
+//! Complex conjugate, specialized for std::complex
+template<typename T>
+inline std::complex<T> __QST_davidson_conj (const std::complex<T>& x) { return std::conj(x); }
+
+//! Block Davidson (Lanczos) eigensolver for QSTArray
+/*! Computes the lowest eigenpairs of hermitian operator given by sigma functor, f(x, y) : y = H * x.
+ *
+ *  Trial vectors are orthonormalized as they are added to the subspace, so that no overlap matrix is needed,
+ *  and projected operator is updated incrementally, i.e. only one row is computed for each new vector.
+ *  When the subspace is full, it is collapsed to the leading Ritz vectors (thick restart).
+ *  Vector operations are done by fused kernels in QSTfused.h, e.g. residual, its norm and preconditioner in one pass.
+ *
+ *  Trial and sigma vectors are held as workspace and reused for the next call,
+ *  thus a solver object should be kept alive during sweeps, e.g. for each site of DMRG.
+ */
+#ifdef _ENABLE_DEFAULT_QUANTUM
+template<typename T, size_t N, class Q = Quantum>
+#else
+template<typename T, size_t N, class Q>
+#endif
+class QSTdavidson
+{
+public:
+
+   typedef typename remove_complex<T>::type T_real;
+
+   typedef QSTArray<T, N, Q> Vector;
+
+   //! Sigma functor, y = H * x, where y is given as an empty array, or as the previous sigma vector if set_sigma_in_place(true)
+   typedef boost::function<void(const Vector&, Vector&)> Functor;
+
+   //! Block sigma functor, y[i] = H * x[i] for all i
+   typedef boost::function<void(const std::vector<Vector>&, std::vector<Vector>&)> BlockFunctor;
+
+   //! Constructor
+   /*! \param max_subspace max. number of trial vectors
+    *  \param max_iter max. number of subspace expansions
+    *  \param tol convergence threshold of residual norm
+    *  \param expansion Davidson or Lanczos */
+   QSTdavidson (
+      int max_subspace = 20,
+      int max_iter = 100,
+      T_real tol = 1.0e-4,
+      BTAS_SUBSPACE_EXPANSION expansion = DavidsonExpansion)
+   :  m_max_subspace (max_subspace),
+      m_max_iter (max_iter),
+      m_tol (tol),
+      m_expansion (expansion),
+      m_sigma_in_place (false),
+      m_iterations (0)
+   {
+      BTAS_THROW(max_subspace > 1, "btas::QSTdavidson: max. subspace dimension must be larger than 1");
+   }
+
+   void set_max_subspace (int max_subspace) {
+      BTAS_THROW(max_subspace > 1, "btas::QSTdavidson: max. subspace dimension must be larger than 1");
+      m_max_subspace = max_subspace;
+   }
+   void set_max_iter (int max_iter) { m_max_iter = max_iter; }
+   void set_tol (T_real tol) { m_tol = tol; }
+   void set_expansion (BTAS_SUBSPACE_EXPANSION expansion) { m_expansion = expansion; }
+   //! If true, sigma vector is passed to the functor without clearing, so that its blocks can be overwritten without reallocation
+   void set_sigma_in_place (bool in_place) { m_sigma_in_place = in_place; }
+
+   //! Number of subspace expansions done in the last call
+   int iterations () const { return m_iterations; }
+
+   //! Residual norms of the last call
+   const std::vector<T_real>& residuals () const { return m_rnorm; }
+
+   //! Solve the lowest eigenpair
+   /*! \param x on entry, initial guess, on exit, eigenvector
+    *  \return eigenvalue */
+   T_real solve (const Functor& f_sigma, const Vector& diag, Vector& x)
+   {
+      std::vector<Vector> xs(1);
+      Copy(x, xs[0]);
+      std::vector<T_real> evals = solve(f_sigma, diag, xs, 1);
+      Copy(xs[0], x);
+      return evals[0];
+   }
+
+   //! Solve nroots lowest eigenpairs
+   /*! \param x on entry, initial guesses (at least one), on exit, nroots eigenvectors.
+    *         If less than nroots guesses are given, the subspace is extended by H * x.
+    *  \return nroots eigenvalues in ascending order */
+   std::vector<T_real> solve (const Functor& f_sigma, const Vector& diag, std::vector<Vector>& x, int nroots)
+   {
+      return solve(f_sigma, BlockFunctor(), diag, x, nroots);
+   }
+
+   //! Solve nroots lowest eigenpairs, using block sigma functor to expand subspace by several vectors at once
+   /*! \param f_block block sigma functor, used when more than one vector is added to the subspace
+    *  \param f_sigma sigma functor, used for single vector */
+   std::vector<T_real> solve (const Functor& f_sigma, const BlockFunctor& f_block, const Vector& diag, std::vector<Vector>& x, int nroots)
+   {
+      m_f_sigma = f_sigma;
+      m_f_block = f_block;
+
+      BTAS_THROW(!x.empty(), "btas::QSTdavidson::solve: no initial guess is given");
+      BTAS_THROW(nroots > 0 && 2*nroots <= m_max_subspace, "btas::QSTdavidson::solve: too many roots for max. subspace dimension");
+
+      mf_reserve(nroots);
+
+      // initial subspace
+      int m = 0;
+      for(int k = 0; k < x.size() && m < nroots; ++k) {
+         Copy(x[k], *m_resid[0]);
+         m = mf_append(*m_resid[0], m);
+      }
+      BTAS_THROW(m > 0, "btas::QSTdavidson::solve: initial guess is zero");
+      mf_sigma(0, m);
+      for(int k = m-1; m < nroots; ++k) {
+         Copy(*m_sigma[k], *m_resid[0]);
+         int n = mf_append(*m_resid[0], m);
+         BTAS_THROW(n > m, "btas::QSTdavidson::solve: failed to generate initial subspace");
+         mf_sigma(m, n);
+         m = n;
+      }
+
+      std::vector<T_real> theta;
+      std::vector<T> c;
+
+      m_rnorm.assign(nroots, static_cast<T_real>(0));
+      for(m_iterations = 0; m_iterations < m_max_iter; ++m_iterations) {
+         mf_subspace_eigen(m, theta, c);
+
+         // residuals of unconverged roots, which are preconditioned in the same pass
+         const Vector* pdiag = (m_expansion == DavidsonExpansion) ? &diag : 0;
+         int n_resid = 0;
+         for(int k = 0; k < nroots; ++k) {
+            mf_column(c, m, k);
+            m_rnorm[k] = QSTresidual(mf_vectors(m_sigma, m), mf_vectors(m_trial, m), m_coef, theta[k], pdiag, *m_resid[n_resid]);
+            if(m_rnorm[k] < m_tol) continue;
+            ++n_resid;
+         }
+         if(n_resid == 0) break;
+
+         // thick restart: subspace is collapsed to leading Ritz vectors
+         if(m + n_resid > m_max_subspace) {
+            int n_keep = std::max(nroots, std::min(m, m_max_subspace / 2));
+            n_keep = std::min(n_keep, m_max_subspace - n_resid);
+            mf_collapse(m, n_keep, theta, c);
+            m = n_keep;
+         }
+
+         // expand subspace
+         int m_save = m;
+         for(int k = 0; k < n_resid; ++k)
+            m = mf_append(*m_resid[k], m);
+         if(m == m_save) break;
+         mf_sigma(m_save, m);
+      }
+
+      // eigenvectors
+      mf_subspace_eigen(m, theta, c);
+      x.resize(nroots);
+      for(int k = 0; k < nroots; ++k)
+         mf_rotate(m_trial, m, c, k, x[k]);
+
+      theta.resize(nroots);
+      return theta;
+   }
+
+private:
+
+   //! Allocate workspace, which is kept for the next call
+   void mf_reserve (int nroots)
+   {
+      while(m_trial.size() < m_max_subspace) m_trial.push_back(shared_ptr<Vector>(new Vector()));
+      while(m_sigma.size() < m_max_subspace) m_sigma.push_back(shared_ptr<Vector>(new Vector()));
+      while(m_work .size() < m_max_subspace) m_work .push_back(shared_ptr<Vector>(new Vector()));
+      while(m_resid.size() < nroots)         m_resid.push_back(shared_ptr<Vector>(new Vector()));
+      m_heff.resize(m_max_subspace * m_max_subspace);
+   }
+
+   //! Orthonormalize v to trial vectors [0, m), and append it to the subspace
+   /*! \return new subspace dimension, which equals to m if v is linearly dependent */
+   int mf_append (Vector& v, int m)
+   {
+      const T_real tol = 1.0e-8;
+      if(QSTorthonormalize(mf_vectors(m_trial, m), v, *m_trial[m], tol) < tol) return m;
+      return m+1;
+   }
+
+   //! Compute sigma vectors of trial vectors [m0, m), and update projected operator by the new rows and columns
+   void mf_sigma (int m0, int m)
+   {
+      if(m0 == m) return;
+
+      if(m_f_block && m-m0 > 1) {
+         std::vector<Vector> x(m-m0);
+         std::vector<Vector> y;
+         for(int i = m0; i < m; ++i) Copy(*m_trial[i], x[i-m0]);
+         m_f_block(x, y);
+         BTAS_THROW(y.size() == m-m0, "btas::QSTdavidson: block sigma functor returned wrong number of vectors");
+         for(int i = m0; i < m; ++i) Copy(y[i-m0], *m_sigma[i]);
+      }
+      else {
+         for(int i = m0; i < m; ++i) {
+            if(!m_sigma_in_place) m_sigma[i]->clear();
+            m_f_sigma(*m_trial[i], *m_sigma[i]);
+         }
+      }
+
+      for(int j = m0; j < m; ++j) {
+         std::vector<T> hj = QSTdotc(mf_vectors(m_trial, j+1), *m_sigma[j]);
+         for(int i = 0; i <= j; ++i) {
+            m_heff[i*m_max_subspace+j] = hj[i];
+            m_heff[j*m_max_subspace+i] = __QST_davidson_conj(hj[i]);
+         }
+      }
+   }
+
+   //! Solve projected eigenvalue problem, Ritz vector k is stored in column k of c (m x m)
+   void mf_subspace_eigen (int m, std::vector<T_real>& theta, std::vector<T>& c)
+   {
+      c.resize(m*m);
+      for(int i = 0; i < m; ++i)
+         std::copy(m_heff.begin()+i*m_max_subspace, m_heff.begin()+i*m_max_subspace+m, c.begin()+i*m);
+      theta.resize(m);
+      heev(EigAuto, LAPACK_ROW_MAJOR, 'V', 'U', m, c.data(), m, theta.data(), 0, c.data(), m);
+   }
+
+   //! Pointers to vectors [0, m)
+   static std::vector<const Vector*> mf_vectors (const std::vector<shared_ptr<Vector>>& v, int m)
+   {
+      std::vector<const Vector*> ptrs(m);
+      for(int i = 0; i < m; ++i) ptrs[i] = v[i].get();
+      return ptrs;
+   }
+
+   //! Copy column k of c (m x m) to m_coef
+   void mf_column (const std::vector<T>& c, int m, int k)
+   {
+      m_coef.resize(m);
+      for(int i = 0; i < m; ++i) m_coef[i] = c[i*m+k];
+   }
+
+   //! y = sum_i c(i, k) * v[i]
+   void mf_rotate (const std::vector<shared_ptr<Vector>>& v, int m, const std::vector<T>& c, int k, Vector& y)
+   {
+      mf_column(c, m, k);
+      QSTcombine(mf_vectors(v, m), m_coef, y);
+   }
+
+   //! Collapse subspace to n_keep leading Ritz vectors, on which projected operator is diagonal
+   void mf_collapse (int m, int n_keep, const std::vector<T_real>& theta, const std::vector<T>& c)
+   {
+      for(int k = 0; k < n_keep; ++k)
+         mf_rotate(m_trial, m, c, k, *m_work[k]);
+      for(int k = 0; k < n_keep; ++k)
+         std::swap(m_trial[k], m_work[k]);
+      for(int k = 0; k < n_keep; ++k)
+         mf_rotate(m_sigma, m, c, k, *m_work[k]);
+      for(int k = 0; k < n_keep; ++k)
+         std::swap(m_sigma[k], m_work[k]);
+
+      std::fill(m_heff.begin(), m_heff.end(), static_cast<T>(0));
+      for(int k = 0; k < n_keep; ++k)
+         m_heff[k*m_max_subspace+k] = theta[k];
+   }
+
+   //! Sigma functor of the current call
+   Functor m_f_sigma;
+
+   //! Block sigma functor of the current call, which may be empty
+   BlockFunctor m_f_block;
+
+   //! Max. number of trial vectors
+   int m_max_subspace;
+
+   //! Max. number of subspace expansions
+   int m_max_iter;
+
+   //! Convergence threshold of residual norm
+   T_real m_tol;
+
+   //! Subspace expansion
+   BTAS_SUBSPACE_EXPANSION m_expansion;
+
+   //! Sigma vector is overwritten by the functor
+   bool m_sigma_in_place;
+
+   //! Number of iterations done in the last call
+   int m_iterations;
+
+   //! Residual norms of the last call
+   std::vector<T_real> m_rnorm;
+
+   //! Orthonormal trial vectors
+   std::vector<shared_ptr<Vector>> m_trial;
+
+   //! Sigma vectors
+   std::vector<shared_ptr<Vector>> m_sigma;
+
+   //! Work space for thick restart
+   std::vector<shared_ptr<Vector>> m_work;
+
+   //! Residual vectors
+   std::vector<shared_ptr<Vector>> m_resid;
+
+   //! Coefficients passed to fused kernels
+   std::vector<T> m_coef;
+
+   //! Projected operator, m_max_subspace x m_max_subspace
+   std::vector<T> m_heff;
+};
+
+}; // namespace btas
+
+#endif // __BTAS_QSPARSE_QSTDAVIDSON_H
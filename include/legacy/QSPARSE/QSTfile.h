@@ -0,0 +1,119 @@
+#ifndef __BTAS_QSPARSE_QSTFILE_H
+#define __BTAS_QSPARSE_QSTFILE_H 1
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#include <legacy/SPARSE/STfile.h>
+
+#include <legacy/QSPARSE/QSTArray.h>
+
+namespace btas
+{
+
+//  ====================================================================================================
+//  Quantum numbers are stored in extra section of STfile format as
+//
+//  uint64 sizeof(Q), Q q_total, Q qshape(i)[n(i)] for each rank i
+//
+//  Q is copied byte-wise, as well as QSThash does, so it must be trivially copyable.
+//  ====================================================================================================
+
+/// Write quantum number-based block-sparse array to file
+template<typename T, size_t N, class Q>
+void QSTsave (const QSTArray<T, N, Q>& x, const std::string& fname)
+{
+   size_t nq = 1;
+   for(int i = 0; i < N; ++i) nq += x.qshape(i).size();
+
+   std::vector<char> extra(sizeof(uint64_t) + sizeof(Q) * nq);
+   char* p = extra.data();
+   uint64_t qsize = sizeof(Q);
+   std::memcpy(p, &qsize, sizeof(qsize)); p += sizeof(qsize);
+   std::memcpy(p, &x.q(), sizeof(Q)); p += sizeof(Q);
+   for(int i = 0; i < N; ++i) {
+      const Qshapes<Q>& qi = x.qshape(i);
+      for(int k = 0; k < qi.size(); ++k) {
+         std::memcpy(p, &qi[k], sizeof(Q)); p += sizeof(Q);
+      }
+   }
+
+   STsave(x, fname, extra);
+}
+
+/// Memory-mapped reader of quantum number-based block-sparse array file
+template<typename T, size_t N, class Q>
+class QSTmappedFile : public STmappedFile<T, N>
+{
+public:
+
+   explicit QSTmappedFile (const std::string& fname)
+   : STmappedFile<T, N>(fname)
+   {
+      const char* p = this->extra();
+      uint64_t qsize = 0;
+      BTAS_THROW(this->extra_size() >= sizeof(qsize), "btas::QSTmappedFile: no quantum numbers in file");
+      std::memcpy(&qsize, p, sizeof(qsize)); p += sizeof(qsize);
+      BTAS_THROW(qsize == sizeof(Q), "btas::QSTmappedFile: quantum number type mismatched");
+
+      size_t nq = 1;
+      for(int i = 0; i < N; ++i) nq += this->dshape(i).size();
+      BTAS_THROW(this->extra_size() == sizeof(qsize) + sizeof(Q) * nq, "btas::QSTmappedFile: quantum numbers are truncated");
+
+      std::memcpy(&m_q_total, p, sizeof(Q)); p += sizeof(Q);
+      for(int i = 0; i < N; ++i) {
+         m_q_shape[i].resize(this->dshape(i).size());
+         for(int k = 0; k < m_q_shape[i].size(); ++k) {
+            std::memcpy(&m_q_shape[i][k], p, sizeof(Q)); p += sizeof(Q);
+         }
+      }
+   }
+
+   const Q& q () const { return m_q_total; }
+
+   const TVector<Qshapes<Q>, N>& qshape () const { return m_q_shape; }
+
+   const Dshapes& dshape (int i) const { return STmappedFile<T, N>::dshape()[i]; }
+
+   const TVector<Dshapes, N>& dshape () const { return STmappedFile<T, N>::dshape(); }
+
+   /// Load whole array
+   void load (QSTArray<T, N, Q>& x) const
+   {
+      x.clear();
+      x.resize(m_q_total, m_q_shape, this->dshape(), false);
+      std::vector<const STblockView<T, N>*> blocks;
+      blocks.reserve(this->nnz());
+      for(auto ib = this->begin(); ib != this->end(); ++ib) blocks.push_back(&(*ib));
+      this->mf_load_blocks(blocks, x);
+   }
+
+   /// Load blocks specified by tags, which are not in file are skipped
+   void load (QSTArray<T, N, Q>& x, const std::vector<int>& tags) const
+   {
+      x.clear();
+      x.resize(m_q_total, m_q_shape, this->dshape(), false);
+      this->mf_load_blocks(this->mf_find_blocks(tags), x);
+   }
+
+private:
+
+   Q m_q_total;
+
+   TVector<Qshapes<Q>, N> m_q_shape;
+};
+
+/// Load quantum number-based block-sparse array from file
+template<typename T, size_t N, class Q>
+void QSTload (const std::string& fname, QSTArray<T, N, Q>& x)
+{
+   QSTmappedFile<T, N, Q> file(fname);
+   file.willneed();
+   file.load(x);
+}
+
+}; // namespace btas
+
+#endif // __BTAS_QSPARSE_QSTFILE_H
@@ -0,0 +1,411 @@
+#ifndef __BTAS_QSPARSE_QSTFUSED_H
+#define __BTAS_QSPARSE_QSTFUSED_H 1
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <legacy/common/btas.h>
+#include <legacy/common/TVector.h>
+#include <legacy/common/numeric_traits.h>
+
+#include <legacy/QSPARSE/QSTArray.h>
+
+namespace btas
+{
+
+//  ====================================================================================================
+//  Fused kernels of Davidson vector operations
+//
+//  Vectors are joined by merging their block maps, which are sorted by tag, so that blocks of the same tag
+//  are visited together without map lookup, and each kernel streams them in a single pass, in parallel over tags.
+//  Partial sums are stored for each tag and added up in order of tag, thus results don't depend on the number of threads,
+//  as is required where every process runs the same solver (see QSTcomm.h).
+//  All vectors must have the same quantum number and shapes.
+//  ====================================================================================================
+
+//! Complex conjugate, which keeps real type as it is
+template<typename T>
+inline T __QST_fused_conj (const T& x) { return x; }
+
+//! Complex conjugate, specialized for std::complex
+template<typename T>
+inline std::complex<T> __QST_fused_conj (const std::complex<T>& x) { return std::conj(x); }
+
+//! Blocks of vectors x[0], ..., x[k-1] joined by tag
+template<typename T>
+struct QSTjoined
+{
+   //! Union of tags in ascending order
+   std::vector<int> tags;
+
+   //! Block size for each tag
+   std::vector<size_t> sizes;
+
+   //! Block of x[i] for tags[t] is stored at t*k+i, or null if x[i] doesn't have it
+   std::vector<T*> blocks;
+
+   size_t k;
+
+   T* operator() (size_t t, size_t i) const { return blocks[t*k+i]; }
+};
+
+//! Merge join of block maps of x, which may be null
+template<typename T, size_t N, class Q>
+void QSTjoin (const std::vector<const QSTArray<T, N, Q>*>& x, QSTjoined<T>& j)
+{
+   typedef typename QSTArray<T, N, Q>::const_iterator Iterator;
+   const size_t k = x.size();
+   std::vector<Iterator> it(k), last(k);
+   for(size_t i = 0; i < k; ++i) {
+      if(!x[i]) continue;
+      it[i] = x[i]->begin();
+      last[i] = x[i]->end();
+   }
+   j.tags.clear();
+   j.sizes.clear();
+   j.blocks.clear();
+   j.k = k;
+   while(true) {
+      int tag = std::numeric_limits<int>::max();
+      bool found = false;
+      for(size_t i = 0; i < k; ++i)
+         if(x[i] && it[i] != last[i] && it[i]->first <= tag) { tag = it[i]->first; found = true; }
+      if(!found) break;
+      size_t size = 0;
+      for(size_t i = 0; i < k; ++i) {
+         if(x[i] && it[i] != last[i] && it[i]->first == tag) {
+            size = it[i]->second->size();
+            j.blocks.push_back(const_cast<T*>(it[i]->second->data()));
+            ++it[i];
+         }
+         else {
+            j.blocks.push_back(0);
+         }
+      }
+      j.tags.push_back(tag);
+      j.sizes.push_back(size);
+   }
+}
+
+//! Make y have blocks of tags with the shape of x, and return pointers to them
+/*! If y already has exactly these blocks, they are reused without allocation. Values are not initialized. */
+template<typename T, size_t N, class Q>
+std::vector<T*> QSTreserve (const QSTArray<T, N, Q>& x, const std::vector<int>& tags, QSTArray<T, N, Q>& y)
+{
+   std::vector<T*> ptrs(tags.size(), 0);
+   bool reuse = y.q() == x.q() && y.qshape() == x.qshape() && y.dshape() == x.dshape() && y.nnz() == tags.size();
+   if(reuse) {
+      auto it = y.begin();
+      for(size_t t = 0; reuse && t < tags.size(); ++t, ++it) {
+         reuse = (it->first == tags[t]);
+         ptrs[t] = it->second->data();
+      }
+   }
+   if(!reuse) {
+      // allocation is done serially, since it modifies std::map
+      y.resize(x.q(), x.qshape(), x.dshape(), false);
+      for(size_t t = 0; t < tags.size(); ++t) ptrs[t] = y.reserve(tags[t])->second->data();
+   }
+   return ptrs;
+}
+
+//! Sum of partial sums p(t, i) over t, for each i, in order of t
+template<typename T>
+inline std::vector<T> __QST_fused_sum (const std::vector<T>& p, size_t n)
+{
+   std::vector<T> s(n, static_cast<T>(0));
+   for(size_t t = 0; t < p.size()/n; ++t)
+      for(size_t i = 0; i < n; ++i) s[i] += p[t*n+i];
+   return s;
+}
+
+//! Check that x have the same quantum number and shapes as x0
+template<typename T, size_t N, class Q>
+inline void __QST_fused_check (const QSTArray<T, N, Q>& x0, const std::vector<const QSTArray<T, N, Q>*>& x, const char* msg)
+{
+   for(size_t i = 0; i < x.size(); ++i)
+      BTAS_THROW(!x[i] || (x[i]->q() == x0.q() && x[i]->qshape() == x0.qshape()), msg);
+}
+
+//! y = sum_i c[i] * x[i]
+template<typename T, size_t N, class Q>
+void QSTcombine (const std::vector<const QSTArray<T, N, Q>*>& x, const std::vector<T>& c, QSTArray<T, N, Q>& y)
+{
+   BTAS_THROW(!x.empty() && x.size() == c.size(), "btas::QSTcombine: number of vectors and coefficients mismatched");
+   __QST_fused_check(*x[0], x, "btas::QSTcombine: vectors must have the same shape");
+
+   QSTjoined<T> j;
+   QSTjoin(x, j);
+   std::vector<T*> py = QSTreserve(*x[0], j.tags, y);
+
+   const size_t k = x.size();
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t t = 0; t < j.tags.size(); ++t) {
+      T* __restrict yt = py[t];
+      const size_t n = j.sizes[t];
+      std::fill(yt, yt+n, static_cast<T>(0));
+      for(size_t i = 0; i < k; ++i) {
+         const T* __restrict xt = j(t, i);
+         if(!xt) continue;
+         const T a = c[i];
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+         for(size_t e = 0; e < n; ++e) yt[e] += a * xt[e];
+      }
+   }
+}
+
+//! d[i] = Dotc(x[i], y) for all i, in one pass over y
+template<typename T, size_t N, class Q>
+std::vector<T> QSTdotc (const std::vector<const QSTArray<T, N, Q>*>& x, const QSTArray<T, N, Q>& y)
+{
+   __QST_fused_check(y, x, "btas::QSTdotc: vectors must have the same shape");
+
+   const size_t k = x.size();
+   std::vector<const QSTArray<T, N, Q>*> xy(x);
+   xy.push_back(&y);
+   QSTjoined<T> j;
+   QSTjoin(xy, j);
+
+   std::vector<T> p(j.tags.size()*k, static_cast<T>(0));
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t t = 0; t < j.tags.size(); ++t) {
+      const T* yt = j(t, k);
+      if(!yt) continue;
+      const size_t n = j.sizes[t];
+      for(size_t i = 0; i < k; ++i) {
+         const T* xt = j(t, i);
+         if(!xt) continue;
+         T s = static_cast<T>(0);
+         for(size_t e = 0; e < n; ++e) s += __QST_fused_conj(xt[e]) * yt[e];
+         p[t*k+i] = s;
+      }
+   }
+   return __QST_fused_sum(p, k);
+}
+
+//! Residual and Davidson's preconditioner in one pass
+/*! r = sum_i c[i] * (sigma[i] - theta * trial[i]), and if diag is given, r is preconditioned as r / (theta - diag),
+ *  where r is divided by theta for blocks which diag doesn't have.
+ *  \return norm of residual before preconditioning */
+template<typename T, size_t N, class Q>
+typename remove_complex<T>::type QSTresidual (
+      const std::vector<const QSTArray<T, N, Q>*>& sigma,
+      const std::vector<const QSTArray<T, N, Q>*>& trial,
+      const std::vector<T>& c,
+      const typename remove_complex<T>::type& theta,
+      const QSTArray<T, N, Q>* diag,
+            QSTArray<T, N, Q>& r)
+{
+   typedef typename remove_complex<T>::type T_real;
+   const size_t m = c.size();
+   BTAS_THROW(m > 0 && sigma.size() == m && trial.size() == m, "btas::QSTresidual: number of vectors and coefficients mismatched");
+
+   // joined as sigma[0], trial[0], sigma[1], trial[1], ..., diag
+   std::vector<const QSTArray<T, N, Q>*> x;
+   for(size_t i = 0; i < m; ++i) {
+      x.push_back(sigma[i]);
+      x.push_back(trial[i]);
+   }
+   __QST_fused_check(*trial[0], x, "btas::QSTresidual: vectors must have the same shape");
+   if(diag) BTAS_THROW(diag->qshape() == trial[0]->qshape(), "btas::QSTresidual: diag must have the same shape");
+   x.push_back(diag);
+
+   QSTjoined<T> j;
+   QSTjoin(x, j);
+   // blocks which only diag has are not needed
+   std::vector<int> tags;
+   std::vector<size_t> rows;
+   for(size_t t = 0; t < j.tags.size(); ++t) {
+      bool any = false;
+      for(size_t i = 0; i < 2*m && !any; ++i) any = (j(t, i) != 0);
+      if(!any) continue;
+      tags.push_back(j.tags[t]);
+      rows.push_back(t);
+   }
+   std::vector<T*> pr = QSTreserve(*trial[0], tags, r);
+
+   const T_real tiny = static_cast<T_real>(1.0e-12);
+   std::vector<T_real> p(tags.size(), static_cast<T_real>(0));
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t u = 0; u < tags.size(); ++u) {
+      const size_t t = rows[u];
+      T* __restrict rt = pr[u];
+      const size_t n = j.sizes[t];
+      std::fill(rt, rt+n, static_cast<T>(0));
+      for(size_t i = 0; i < m; ++i) {
+         const T* __restrict st = j(t, 2*i);
+         const T* __restrict xt = j(t, 2*i+1);
+         const T a = c[i];
+         const T b = -static_cast<T>(theta) * c[i];
+         if(st) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+            for(size_t e = 0; e < n; ++e) rt[e] += a * st[e];
+         }
+         if(xt) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+            for(size_t e = 0; e < n; ++e) rt[e] += b * xt[e];
+         }
+      }
+      T_real s = static_cast<T_real>(0);
+      for(size_t e = 0; e < n; ++e) s += std::norm(rt[e]);
+      p[u] = s;
+      if(!diag) continue;
+      const T* dt = j(t, 2*m);
+      if(dt) {
+         for(size_t e = 0; e < n; ++e) {
+            T denm = static_cast<T>(theta) - dt[e];
+            if(std::abs(denm) < tiny) denm = tiny;
+            rt[e] /= denm;
+         }
+      }
+      else {
+         const T a = static_cast<T>(1.0/theta);
+         for(size_t e = 0; e < n; ++e) rt[e] *= a;
+      }
+   }
+   return std::sqrt(__QST_fused_sum(p, 1)[0]);
+}
+
+//! Davidson's preconditioner, r = r / (theta - diag), where r is divided by theta for blocks which diag doesn't have
+template<typename T, size_t N, class Q>
+void QSTprecondition (const typename remove_complex<T>::type& theta, const QSTArray<T, N, Q>& diag, QSTArray<T, N, Q>& r)
+{
+   typedef typename remove_complex<T>::type T_real;
+   std::vector<const QSTArray<T, N, Q>*> x(2);
+   x[0] = &r;
+   x[1] = &diag;
+   QSTjoined<T> j;
+   QSTjoin(x, j);
+
+   const T_real tiny = static_cast<T_real>(1.0e-12);
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t t = 0; t < j.tags.size(); ++t) {
+      T* rt = j(t, 0);
+      if(!rt) continue;
+      const T* dt = j(t, 1);
+      const size_t n = j.sizes[t];
+      if(dt) {
+         for(size_t e = 0; e < n; ++e) {
+            T denm = static_cast<T>(theta) - dt[e];
+            if(std::abs(denm) < tiny) denm = tiny;
+            rt[e] /= denm;
+         }
+      }
+      else {
+         const T a = static_cast<T>(1.0/theta);
+         for(size_t e = 0; e < n; ++e) rt[e] *= a;
+      }
+   }
+}
+
+//! Orthonormalize v to orthonormal basis, and store it to y
+/*! Gram-Schmidt is done twice for numerical stability. Since projections need overlaps summed over all blocks,
+ *  it takes 4 passes: overlaps and norm, 1st projection fused with overlaps for the 2nd, 2nd projection fused with norm,
+ *  and scaling into y. v is overwritten by the orthogonalized vector.
+ *  \return norm of the orthogonalized v relative to the original, y is not touched if it's smaller than tol */
+template<typename T, size_t N, class Q>
+typename remove_complex<T>::type QSTorthonormalize (
+      const std::vector<const QSTArray<T, N, Q>*>& basis,
+            QSTArray<T, N, Q>& v,
+            QSTArray<T, N, Q>& y,
+      const typename remove_complex<T>::type& tol = 1.0e-8)
+{
+   typedef typename remove_complex<T>::type T_real;
+   __QST_fused_check(v, basis, "btas::QSTorthonormalize: vectors must have the same shape");
+
+   // v is extended to have all blocks of basis, since projections may fill them
+   const size_t m = basis.size();
+   std::vector<const QSTArray<T, N, Q>*> x(basis);
+   x.push_back(&v);
+   QSTjoined<T> j;
+   QSTjoin(x, j);
+   for(size_t t = 0; t < j.tags.size(); ++t) {
+      if(j.blocks[t*j.k+m]) continue;
+      auto it = v.reserve(j.tags[t]);
+      std::fill(it->second->begin(), it->second->end(), static_cast<T>(0));
+      j.blocks[t*j.k+m] = it->second->data();
+   }
+
+   const size_t ntag = j.tags.size();
+   const size_t np = m+1; // overlaps and norm
+   std::vector<T> p(ntag*np);
+
+   // pass: v -= sum_i s[i] * basis[i], then partial overlaps (or norm only if overlaps is false)
+   auto project = [&] (const std::vector<T>* s, bool overlaps) {
+      std::fill(p.begin(), p.end(), static_cast<T>(0));
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+      for(size_t t = 0; t < ntag; ++t) {
+         T* __restrict vt = j(t, m);
+         const size_t n = j.sizes[t];
+         if(s) {
+            for(size_t i = 0; i < m; ++i) {
+               const T* __restrict bt = j(t, i);
+               if(!bt) continue;
+               const T a = -(*s)[i];
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+               for(size_t e = 0; e < n; ++e) vt[e] += a * bt[e];
+            }
+         }
+         for(size_t i = 0; overlaps && i < m; ++i) {
+            const T* bt = j(t, i);
+            if(!bt) continue;
+            T d = static_cast<T>(0);
+            for(size_t e = 0; e < n; ++e) d += __QST_fused_conj(bt[e]) * vt[e];
+            p[t*np+i] = d;
+         }
+         T_real d = static_cast<T_real>(0);
+         for(size_t e = 0; e < n; ++e) d += std::norm(vt[e]);
+         p[t*np+m] = d;
+      }
+      return __QST_fused_sum(p, np);
+   };
+
+   std::vector<T> s1 = project(0, true);
+   T_real vnorm = std::sqrt(std::abs(s1[m]));
+   if(vnorm == static_cast<T_real>(0)) return static_cast<T_real>(0);
+   std::vector<T> s2 = project(&s1, true);
+   std::vector<T> s3 = project(&s2, false);
+   T_real onorm = std::sqrt(std::abs(s3[m]));
+   if(onorm < tol * vnorm) return onorm / vnorm;
+
+   std::vector<T*> py = QSTreserve(v, j.tags, y);
+   const T a = static_cast<T>(1.0/onorm);
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(size_t t = 0; t < ntag; ++t) {
+      const T* __restrict vt = j(t, m);
+      T* __restrict yt = py[t];
+      const size_t n = j.sizes[t];
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+      for(size_t e = 0; e < n; ++e) yt[e] = a * vt[e];
+   }
+   return onorm / vnorm;
+}
+
+} // namespace btas
+
+#endif // __BTAS_QSPARSE_QSTFUSED_H
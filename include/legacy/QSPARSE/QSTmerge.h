@@ -12,12 +12,28 @@
  *  - Row-expand: { Rows-info(i,j <-> r), A(r,k,l) } -> B(i,j,k,l)
  *  - Column-expand: { A(i,j,c), Cols-info(k,l <-> c) } -> B(i,j,k,l)
  *  - Row/Column-expand: { Rows-info(i,j <-> r), A(r,c), Cols-info(k,l <-> c) } -> B(i,j,k,l)
+ *
+ *  \par Merging without copy
+ *  - Row/Column-merge into QSTmergeBlock: { Rows-info(i,j <-> r), A(i,j,k,l), Cols-info(k,l -> c) } -> B(r,c)
+ *    which only refers sub-blocks of A, and packs them into contiguous buffer when needed.
+ *  - Row-expand and Column-expand with selection of leading columns (rows) of merged matrix,
+ *    which truncates and expands A in a single pass.
+ *    Selected columns (rows) can be scaled by diagonal array at the same time, e.g. to absorb singular values.
+ *
+ *  \par Threading
+ *  Destination blocks are allocated serially, then filled by strided copies in parallel,
+ *  since they are disjoint each other.
  */
 
 #ifndef _BTAS_CXX11_QSTMERGE_H
 #define _BTAS_CXX11_QSTMERGE_H 1
 
+#include <map>
+#include <vector>
+#include <algorithm>
+
 #include <legacy/common/btas.h>
+#include <legacy/common/numeric_traits.h>
 
 #include <legacy/DENSE/TSubArray.h>
 
@@ -26,6 +42,123 @@
 
 namespace btas {
 
+   //! Copy (rows x cols) row-major sub-matrix with leading dimensions lds and ldd
+   /*! Inner loop is written as plain loop on restricted pointers so that compiler can vectorise it,
+    *  and contiguous case is done by single copy. */
+   template<typename T>
+      inline void QSTcopy2d(int rows, int cols, const T* src, int lds, T* dst, int ldd)
+      {
+         if(rows <= 0 || cols <= 0) return;
+         if(lds == cols && ldd == cols) {
+            std::copy(src, src+static_cast<size_t>(rows)*cols, dst);
+            return;
+         }
+         for(int r = 0; r < rows; ++r) {
+            const T* __restrict s = src + static_cast<size_t>(r)*lds;
+                  T* __restrict d = dst + static_cast<size_t>(r)*ldd;
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+            for(int c = 0; c < cols; ++c) d[c] = s[c];
+         }
+      }
+
+   //! Copy (rows x cols) row-major sub-matrix with scaling, dst(r,c) = row_scale[r] * src(r,c) * col_scale[c]
+   /*! Null scale is taken to be 1. */
+   template<typename T, typename U>
+      inline void QSTcopy2d(int rows, int cols, const T* src, int lds, T* dst, int ldd, const U* row_scale, const U* col_scale)
+      {
+         if(!row_scale && !col_scale) {
+            QSTcopy2d(rows, cols, src, lds, dst, ldd);
+            return;
+         }
+         for(int r = 0; r < rows; ++r) {
+            const T* __restrict s = src + static_cast<size_t>(r)*lds;
+                  T* __restrict d = dst + static_cast<size_t>(r)*ldd;
+            if(!col_scale) {
+               const U f = row_scale[r];
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+               for(int c = 0; c < cols; ++c) d[c] = f * s[c];
+            }
+            else if(!row_scale) {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+               for(int c = 0; c < cols; ++c) d[c] = s[c] * col_scale[c];
+            }
+            else {
+               const U f = row_scale[r];
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd
+#endif
+               for(int c = 0; c < cols; ++c) d[c] = f * s[c] * col_scale[c];
+            }
+         }
+      }
+
+   //! Copy task to fill single destination block by strided sub-matrix copies
+   /*! Destination blocks of merging and expanding are disjoint, so tasks can be done in parallel without locking.
+    *  Elements not covered by copies are cleared. */
+   template<typename T>
+      struct QSTcopyTask
+      {
+         typedef typename remove_complex<T>::type T_real;
+
+         //! Sub-matrix copy to dst + offset, optionally scaled by rows and/or cols
+         struct Copy
+         {
+            const T* src;
+            int lds;
+            size_t offset;
+            int ldd;
+            int rows;
+            int cols;
+            const T_real* row_scale;
+            const T_real* col_scale;
+         };
+
+         //! Destination block
+         T* dst;
+         size_t size;
+
+         //! Sub-matrix copies
+         std::vector<Copy> copies;
+
+         QSTcopyTask() : dst(0), size(0) { }
+
+         //! Add sub-matrix copy
+         void add(const T* src, int lds, size_t offset, int ldd, int rows, int cols, const T_real* row_scale = 0, const T_real* col_scale = 0) {
+            Copy c = { src, lds, offset, ldd, rows, cols, row_scale, col_scale };
+            copies.push_back(c);
+         }
+
+         //! Do copies
+         void call() const {
+            size_t covered = 0;
+            for(typename std::vector<Copy>::const_iterator it = copies.begin(); it != copies.end(); ++it)
+               covered += static_cast<size_t>(it->rows)*it->cols;
+            if(covered < size) std::fill(dst, dst+size, static_cast<T>(0));
+            for(typename std::vector<Copy>::const_iterator it = copies.begin(); it != copies.end(); ++it)
+               QSTcopy2d(it->rows, it->cols, it->src, it->lds, dst+it->offset, it->ldd, it->row_scale, it->col_scale);
+         }
+      };
+
+   //! Threaded call of copy tasks
+   template<typename T>
+      void QSTcopy_parallel(const std::vector<QSTcopyTask<T>>& tasks)
+      {
+         size_t n = tasks.size();
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+         for(size_t i = 0; i < n; ++i)
+         {
+            tasks[i].call();
+         }
+      }
+
    //! Merging row ranks
    /*! Row-merge: { Rows-info(i,j <-> r), A(i,j,k,l) } -> B(r,k,l) */
    template<typename T, size_t MR, size_t N, class Q>
@@ -50,41 +183,37 @@ namespace btas {
          int a_stride = a.stride(MR-1);
          int b_stride = b.stride(0);
          int b_n_rows = b.shape (0);
-         // loop over merged blocks
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
          for(int i = 0; i < b_n_rows; ++i) {
             typename QSTmergeInfo<MR, Q>::const_range irow_range = rows_info.equal_range(i);
             if(irow_range.first == irow_range.second) continue;
 
             int ib_rows = i * b_stride;
             for(int j = 0; j < b_stride; ++j) {
-               // construct merged dense-tensor
-               IVector<1+MC> b_index = b.index(ib_rows + j);
-               if(!b.allowed(b_index)) continue;
-               TArray<T, 1+MC> block(b.dshape() & b_index); block.fill(0.0);
-
-               // loop over dense-array of a
-               IVector<1+MC> subbeg = uniform<int, 1+MC>(0);
-               IVector<1+MC> subend;
-               for(int i = 0; i < 1+MC; ++i) subend[i] = block.shape(i) - 1;
+               if(!b.allowed(ib_rows + j)) continue;
+               // merged block is (rows x cols) matrix, sub-blocks are contiguous rows
+               int cols = 1;
+               for(int k = 0; k < MC; ++k) cols *= b_dshape[1+k][b.index(ib_rows + j)[1+k]];
 
-               bool non_zero = false;
+               QSTcopyTask<T> task;
                for(typename QSTmergeInfo<MR, Q>::const_iterator itr = irow_range.first; itr != irow_range.second; ++itr) {
                   int irow = itr->second;
-                  int drow = rows_info.dshape_packed(irow);
-                  subend[0] = subbeg[0] + drow - 1;
                   // merge
                   int tag = irow * a_stride + j;
                   typename QSTArray<T, N, Q>::const_iterator ita = a.find(tag);
-                  if(ita != a.end()) {
-                     non_zero = true;
-                     block.subarray(subbeg, subend) = *ita->second;
-                  }
-                  subbeg[0] = subend[0] + 1;
+                  if(ita != a.end())
+                     task.add(ita->second->data(), cols, static_cast<size_t>(rows_info.offset_packed(irow))*cols, cols, rows_info.dshape_packed(irow), cols);
                }
-               if(non_zero)
-                  b.insert(b_index, block);
+               if(task.copies.empty()) continue;
+
+               TArray<T, 1+MC>& block = *b.reserve(ib_rows + j)->second;
+               task.dst  = block.data();
+               task.size = block.size();
+               tasks.push_back(task);
             }
          }
+         QSTcopy_parallel(tasks);
       }
 
    //! Merging col ranks
@@ -111,41 +240,40 @@ namespace btas {
          int a_stride = a.stride(MR-1);
          int b_stride = b.stride(MR-1);
          int b_n_rows = b.size() / b_stride;
-         // loop over merged blocks
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
          for(int i = 0; i < b_n_rows; ++i) {
             int ia_rows = i * a_stride;
             int ib_rows = i * b_stride;
             for(int j = 0; j < b_stride; ++j) {
                typename QSTmergeInfo<MC, Q>::const_range jcol_range = cols_info.equal_range(j);
                if(jcol_range.first == jcol_range.second) continue;
-               // construct merged dense-tensor
+               if(!b.allowed(ib_rows + j)) continue;
+               // merged block is (rows x cols) matrix, sub-blocks are strided columns
+               int rows = 1;
                IVector<MR+1> b_index = b.index(ib_rows + j);
-               if(!b.allowed(b_index)) continue;
-               TArray<T, MR+1> block(b.dshape() & b_index); block.fill(0.0);
-
-               // loop over dense-array of a
-               IVector<MR+1> subbeg = uniform<int, MR+1>(0);
-               IVector<MR+1> subend;
-               for(int i = 0; i < MR+1; ++i) subend[i] = block.shape(i) - 1;
+               for(int k = 0; k < MR; ++k) rows *= b_dshape[k][b_index[k]];
+               int cols = cols_info.dshape_merged(j);
 
-               bool non_zero = false;
+               QSTcopyTask<T> task;
                for(typename QSTmergeInfo<MC, Q>::const_iterator itc = jcol_range.first; itc != jcol_range.second; ++itc) {
                   int jcol = itc->second;
                   int dcol = cols_info.dshape_packed(jcol);
-                  subend[MR] = subbeg[MR] + dcol - 1;
                   // merge
                   int tag = ia_rows + jcol;
                   typename QSTArray<T, N, Q>::const_iterator ita = a.find(tag);
-                  if(ita != a.end()) {
-                     non_zero = true;
-                     block.subarray(subbeg, subend) = *ita->second;
-                  }
-                  subbeg[MR] = subend[MR] + 1;
+                  if(ita != a.end())
+                     task.add(ita->second->data(), dcol, cols_info.offset_packed(jcol), cols, rows, dcol);
                }
-               if(non_zero)
-                  b.insert(b_index, block);
+               if(task.copies.empty()) continue;
+
+               TArray<T, MR+1>& block = *b.reserve(ib_rows + j)->second;
+               task.dst  = block.data();
+               task.size = block.size();
+               tasks.push_back(task);
             }
          }
+         QSTcopy_parallel(tasks);
       }
 
    //! Merging row and col ranks to form matrix
@@ -169,47 +297,42 @@ namespace btas {
          int a_stride = a.stride(MR-1);
          int b_stride = b.stride(0);
          int b_n_rows = b.shape (0);
-         // loop over merged blocks
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
          for(int i = 0; i < b_n_rows; ++i) {
             typename QSTmergeInfo<MR, Q>::const_range irow_range = rows_info.equal_range(i);
             if(irow_range.first == irow_range.second) continue;
             for(int j = 0; j < b_stride; ++j) {
                typename QSTmergeInfo<MC, Q>::const_range jcol_range = cols_info.equal_range(j);
                if(jcol_range.first == jcol_range.second) continue;
-               // construct merged dense-tensor
                IVector<2> b_index = shape(i, j);
                if(!b.allowed(b_index)) continue;
-               TArray<T, 2> block(b.dshape() & b_index); block.fill(0.0);
+               int cols = cols_info.dshape_merged(j);
 
-               // loop over dense-array of a
-               IVector<2> subbeg = uniform<int, 2>(0);
-               IVector<2> subend = uniform<int, 2>(0);
-
-               bool non_zero = false;
+               QSTcopyTask<T> task;
                for(typename QSTmergeInfo<MR, Q>::const_iterator itr = irow_range.first; itr != irow_range.second; ++itr) {
                   int irow = itr->second;
                   int drow = rows_info.dshape_packed(irow);
-                  subend[0] = subbeg[0] + drow - 1;
-                  subbeg[1] = 0;
+                  size_t row_offset = static_cast<size_t>(rows_info.offset_packed(irow))*cols;
                   for(typename QSTmergeInfo<MC, Q>::const_iterator itc = jcol_range.first; itc != jcol_range.second; ++itc) {
                      int jcol = itc->second;
                      int dcol = cols_info.dshape_packed(jcol);
-                     subend[1] = subbeg[1] + dcol - 1;
                      // merge
                      int tag = irow * a_stride + jcol;
                      typename QSTArray<T, N, Q>::const_iterator ita = a.find(tag);
-                     if(ita != a.end()) {
-                        non_zero = true;
-                        block.subarray(subbeg, subend) = *ita->second;
-                     }
-                     subbeg[1] = subend[1] + 1;
+                     if(ita != a.end())
+                        task.add(ita->second->data(), dcol, row_offset + cols_info.offset_packed(jcol), cols, drow, dcol);
                   }
-                  subbeg[0] = subend[0] + 1;
                }
-               if(non_zero)
-                  b.insert(b_index, block);
+               if(task.copies.empty()) continue;
+
+               TArray<T, 2>& block = *b.reserve(b_index)->second;
+               task.dst  = block.data();
+               task.size = block.size();
+               tasks.push_back(task);
             }
          }
+         QSTcopy_parallel(tasks);
       }
 
    //! Expanding row ranks
@@ -247,7 +370,8 @@ namespace btas {
          int a_stride = a.stride(0);
          int b_stride = b.stride(MR-1);
 
-         // loop over merged blocks
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
          for(typename QSTArray<T, 1+MC, Q>::const_iterator ita = a.begin(); ita != a.end(); ++ita) {
 
             int i = ita->first / a_stride;
@@ -255,15 +379,9 @@ namespace btas {
 
             typename QSTmergeInfo<MR, Q>::const_range irow_range = rows_info.equal_range(i);
 
-            // construct merged dense-tensor
-            TArray<T, 1+MC>& block = *(ita->second);
-
-            // loop over dense-array of a
-            IVector<1+MC> subbeg = uniform<int, 1+MC>(0);
-            IVector<1+MC> subend;
-
-            for(int i = 0; i < 1+MC; ++i)
-               subend[i] = block.shape(i) - 1;
+            // merged dense-tensor as (rows x cols) matrix
+            const TArray<T, 1+MC>& block = *(ita->second);
+            int cols = (block.shape(0) > 0) ? block.size() / block.shape(0) : 0;
 
             for(typename QSTmergeInfo<MR, Q>::const_iterator itr = irow_range.first; itr != irow_range.second; ++itr) {
 
@@ -273,21 +391,23 @@ namespace btas {
                // skip if size of block to be created = 0
                if(drow == 0) continue;
 
-               subend[0] = subbeg[0] + drow - 1;
-
                // expand
                int tag = irow * b_stride + j;
 
                typename QSTArray<T, N, Q>::iterator itb = b.reserve(tag);
 
-               if(itb != b.end())
-                  *itb->second = block.subarray(subbeg, subend);
-
-               subbeg[0] = subend[0] + 1;
+               if(itb != b.end()) {
+                  QSTcopyTask<T> task;
+                  task.dst  = itb->second->data();
+                  task.size = itb->second->size();
+                  task.add(block.data() + static_cast<size_t>(rows_info.offset_packed(irow))*cols, cols, 0, cols, drow, cols);
+                  tasks.push_back(task);
+               }
 
             }
 
          }
+         QSTcopy_parallel(tasks);
 
       }
 
@@ -326,7 +446,8 @@ namespace btas {
          int a_stride = a.stride(MR-1);
          int b_stride = b.stride(MR-1);
 
-         // loop over merged blocks
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
          for(typename QSTArray<T, MR+1, Q>::const_iterator ita = a.begin(); ita != a.end(); ++ita) {
 
             int i = ita->first / a_stride;
@@ -334,15 +455,10 @@ namespace btas {
 
             typename QSTmergeInfo<MC, Q>::const_range jcol_range = cols_info.equal_range(j);
 
-            // construct merged dense-tensor
-            TArray<T, MR+1>& block = *(ita->second);
-
-            // loop over dense-array of a
-            IVector<MR+1> subbeg = uniform<int, MR+1>(0);
-            IVector<MR+1> subend;
-
-            for(int i = 0; i < MR+1; ++i) 
-               subend[i] = block.shape(i) - 1;
+            // merged dense-tensor as (rows x cols) matrix
+            const TArray<T, MR+1>& block = *(ita->second);
+            int cols = block.shape(MR);
+            int rows = (cols > 0) ? block.size() / cols : 0;
 
             for(typename QSTmergeInfo<MC, Q>::const_iterator itc = jcol_range.first; itc != jcol_range.second; ++itc) {
 
@@ -352,20 +468,22 @@ namespace btas {
                // skip if size of block to be created = 0
                if(dcol == 0) continue;
 
-               subend[MR] = subbeg[MR] + dcol - 1;
-
                //expand
                int tag = i * b_stride + jcol;
 
                typename QSTArray<T, N, Q>::iterator itb = b.reserve(tag);
 
-               if(itb != b.end())
-                  *itb->second = block.subarray(subbeg, subend);
-
-               subbeg[MR] = subend[MR] + 1;
+               if(itb != b.end()) {
+                  QSTcopyTask<T> task;
+                  task.dst  = itb->second->data();
+                  task.size = itb->second->size();
+                  task.add(block.data() + cols_info.offset_packed(jcol), cols, 0, dcol, rows, dcol);
+                  tasks.push_back(task);
+               }
 
             }
          }
+         QSTcopy_parallel(tasks);
       }
 
    //! Expanding row and col of matrix
@@ -399,7 +517,8 @@ namespace btas {
          int a_stride = a.stride(0);
          int b_stride = b.stride(MR-1);
 
-         // loop over merged blocks
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
          for(typename QSTArray<T, 2, Q>::const_iterator ita = a.begin(); ita != a.end(); ++ita) {
 
             int i = ita->first / a_stride;
@@ -408,12 +527,9 @@ namespace btas {
             typename QSTmergeInfo<MR, Q>::const_range irow_range = rows_info.equal_range(i);
             typename QSTmergeInfo<MC, Q>::const_range jcol_range = cols_info.equal_range(j);
 
-            // construct merged dense-tensor
+            // merged dense-tensor
             const TArray<T, 2>& block = *(ita->second);
-
-            // loop over dense-array of a
-            IVector<2> subbeg = uniform<int, 2>(0);
-            IVector<2> subend = uniform<int, 2>(0);
+            int lda = block.shape(1);
 
             for(typename QSTmergeInfo<MR, Q>::const_iterator itr = irow_range.first; itr != irow_range.second; ++itr) {
 
@@ -422,8 +538,7 @@ namespace btas {
                // skip if size of block to be created = 0
                if(drow == 0) continue;
 
-               subend[0] = subbeg[0] + drow - 1;
-               subbeg[1] = 0;
+               const T* pa = block.data() + static_cast<size_t>(rows_info.offset_packed(irow))*lda;
 
                for(typename QSTmergeInfo<MC, Q>::const_iterator itc = jcol_range.first; itc != jcol_range.second; ++itc) {
 
@@ -432,24 +547,234 @@ namespace btas {
                   // skip if size of block to be created = 0
                   if(dcol == 0) continue;
 
-                  subend[1] = subbeg[1] + dcol - 1;
-
                   // expand
                   int tag = irow * b_stride + jcol;
 
                   typename QSTArray<T, N, Q>::iterator itb = b.reserve(tag);
 
-                  if(itb != b.end())
-                     *itb->second = block.subarray(subbeg, subend);
-
-                  subbeg[1] = subend[1] + 1;
+                  if(itb != b.end()) {
+                     QSTcopyTask<T> task;
+                     task.dst  = itb->second->data();
+                     task.size = itb->second->size();
+                     task.add(pa + cols_info.offset_packed(jcol), lda, 0, dcol, drow, dcol);
+                     tasks.push_back(task);
+                  }
 
                }
 
-               subbeg[0] = subend[0] + 1;
+            }
+         }
+         QSTcopy_parallel(tasks);
+      }
+
+   //! Merged dense block which refers sub-blocks of original array without copy
+   /*! Sub-blocks are stored in row-major order, so that each of them is a contiguous (rows x cols) matrix. */
+   template<typename T>
+      struct QSTmergeBlock
+      {
+         //! Reference to sub-block
+         struct Ref
+         {
+            const T* data;
+            int row_offset;
+            int col_offset;
+            int rows;
+            int cols;
+         };
+
+         //! Merged block size
+         int rows;
+         int cols;
+
+         //! Sub-blocks
+         std::vector<Ref> refs;
+
+         QSTmergeBlock() : rows(0), cols(0) { }
+
+         //! Whether merged block consists of single sub-block, which can be used without packing
+         bool is_single() const { return refs.size() == 1 && refs[0].rows == rows && refs[0].cols == cols; }
+
+         //! Pack sub-blocks into row-major buffer with leading dimension cols
+         void pack(T* buf) const {
+            if(is_single()) {
+               std::copy(refs[0].data, refs[0].data+rows*cols, buf);
+               return;
+            }
+            std::fill(buf, buf+rows*cols, static_cast<T>(0));
+            for(typename std::vector<Ref>::const_iterator it = refs.begin(); it != refs.end(); ++it)
+               QSTcopy2d(it->rows, it->cols, it->data, it->cols, buf + it->row_offset*cols + it->col_offset, cols);
+         }
+      };
+
+   //! Selected leading elements for each quantum number index
+   /*! Used for truncation while expanding merged matrix, e.g. by singular values. */
+   template<class Q>
+      struct QSTselectInfo
+      {
+         //! Quantum numbers of selected indices
+         Qshapes<Q> qshape;
+
+         //! Number of leading elements selected for each selected index
+         Dshapes dshape;
 
+         //! Map from original index to selected index
+         std::map<int, int> index;
+      };
+
+   //! Merging row and col ranks without copy
+   /*! Row/Column-merge: { Rows-info(i,j <-> r), A(i,j,k,l), Cols-info(k,l -> c) } -> B(r,c)
+    *  Only non-zero merged blocks are recorded with tag r * (# of merged cols) + c.
+    *  A must be kept unchanged while B is used. */
+   template<typename T, size_t MR, size_t MC, class Q>
+      void QSTmerge
+      (const QSTmergeInfo<MR, Q>& rows_info, const QSTArray<T, MR+MC, Q>& a, const QSTmergeInfo<MC, Q>& cols_info, std::map<int, QSTmergeBlock<T>>& b)
+      {
+         // strides
+         int a_stride = a.stride(MR-1);
+         int b_stride = cols_info.dshape_merged().size();
+         // loop over non-zero blocks of a
+         b.clear();
+         for(typename QSTArray<T, MR+MC, Q>::const_iterator ita = a.begin(); ita != a.end(); ++ita) {
+            if(ita->second->size() == 0) continue;
+            int irow = ita->first / a_stride;
+            int jcol = ita->first % a_stride;
+            int i = rows_info.index_merged(irow);
+            int j = cols_info.index_merged(jcol);
+            QSTmergeBlock<T>& block = b[i * b_stride + j];
+            block.rows = rows_info.dshape_merged(i);
+            block.cols = cols_info.dshape_merged(j);
+            typename QSTmergeBlock<T>::Ref ref;
+            ref.data       = ita->second->data();
+            ref.row_offset = rows_info.offset_packed(irow);
+            ref.col_offset = cols_info.offset_packed(jcol);
+            ref.rows       = rows_info.dshape_packed(irow);
+            ref.cols       = cols_info.dshape_packed(jcol);
+            block.refs.push_back(ref);
+         }
+      }
+
+   //! Expanding row ranks, taking only selected leading columns
+   /*! Row-expand: { Rows-info(i,j <-> r), A(r,s), Cols-select(s -> s') } -> B(i,j,s')
+    *  Quantum numbers of last index of B are given by cols_select.qshape.
+    *  If cols_scale is given, B(i,j,s') is multiplied by diagonal cols_scale(s') while expanding. */
+   template<typename T, size_t MR, class Q>
+      void QSTexpand
+      (const QSTmergeInfo<MR, Q>& rows_info, const QSTArray<T, 2, Q>& a, const QSTselectInfo<Q>& cols_select, QSTArray<T, MR+1, Q>& b,
+       const STArray<typename remove_complex<T>::type, 1>* cols_scale = 0)
+      {
+         // new qnum shapes
+         TVector<Qshapes<Q>, MR+1> b_qshape;
+         for(int i = 0; i < MR; ++i)
+            b_qshape[i] = rows_info.qshape(i);
+         b_qshape[MR] = cols_select.qshape;
+         // new dense shapes
+         TVector<Dshapes,    MR+1> b_dshape;
+         for(int i = 0; i < MR; ++i)
+            b_dshape[i] = rows_info.dshape(i);
+         b_dshape[MR] = cols_select.dshape;
+         // resizing
+         b.resize(a.q(), b_qshape, b_dshape, false);
+         // strides
+         int a_stride = a.stride(0);
+         int b_stride = b.stride(MR-1);
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
+         for(typename QSTArray<T, 2, Q>::const_iterator ita = a.begin(); ita != a.end(); ++ita) {
+            int i = ita->first / a_stride;
+            int j = ita->first % a_stride;
+            std::map<int, int>::const_iterator jsel = cols_select.index.find(j);
+            if(jsel == cols_select.index.end()) continue;
+            int jcol = jsel->second;
+            int dcol = cols_select.dshape[jcol];
+            const typename remove_complex<T>::type* pscale = 0;
+            if(cols_scale) {
+               typename STArray<typename remove_complex<T>::type, 1>::const_iterator its = cols_scale->find(jcol);
+               BTAS_THROW(its != cols_scale->end() && its->second->size() >= dcol, "btas::QSTexpand: scaling array doesn't match selected columns");
+               pscale = its->second->data();
+            }
+            const TArray<T, 2>& block = *(ita->second);
+            int lda = block.shape(1);
+            // scatter rows
+            typename QSTmergeInfo<MR, Q>::const_range irow_range = rows_info.equal_range(i);
+            int offset = 0;
+            for(typename QSTmergeInfo<MR, Q>::const_iterator itr = irow_range.first; itr != irow_range.second; ++itr) {
+               int irow = itr->second;
+               int drow = rows_info.dshape_packed(irow);
+               if(drow == 0) continue;
+               typename QSTArray<T, MR+1, Q>::iterator itb = b.reserve(irow * b_stride + jcol);
+               if(itb != b.end()) {
+                  QSTcopyTask<T> task;
+                  task.dst  = itb->second->data();
+                  task.size = itb->second->size();
+                  task.add(block.data() + static_cast<size_t>(offset)*lda, lda, 0, dcol, drow, dcol, 0, pscale);
+                  tasks.push_back(task);
+               }
+               offset += drow;
+            }
+         }
+         QSTcopy_parallel(tasks);
+      }
+
+   //! Expanding col ranks, taking only selected leading rows
+   /*! Column-expand: { Rows-select(s -> s'), A(s,c), Cols-info(k,l <-> c) } -> B(s',k,l)
+    *  Quantum numbers of first index of B are given by rows_select.qshape.
+    *  If rows_scale is given, B(s',k,l) is multiplied by diagonal rows_scale(s') while expanding. */
+   template<typename T, size_t MC, class Q>
+      void QSTexpand
+      (const QSTselectInfo<Q>& rows_select, const QSTArray<T, 2, Q>& a, const QSTmergeInfo<MC, Q>& cols_info, QSTArray<T, 1+MC, Q>& b,
+       const STArray<typename remove_complex<T>::type, 1>* rows_scale = 0)
+      {
+         // new qnum shapes
+         TVector<Qshapes<Q>, 1+MC> b_qshape;
+         b_qshape[0] = rows_select.qshape;
+         for(int i = 0; i < MC; ++i)
+            b_qshape[1+i] = cols_info.qshape(i);
+         // new dense shapes
+         TVector<Dshapes,    1+MC> b_dshape;
+         b_dshape[0] = rows_select.dshape;
+         for(int i = 0; i < MC; ++i)
+            b_dshape[1+i] = cols_info.dshape(i);
+         // resizing
+         b.resize(a.q(), b_qshape, b_dshape, false);
+         // strides
+         int a_stride = a.stride(0);
+         int b_stride = b.stride(0);
+         // loop over merged blocks, allocation is done serially
+         std::vector<QSTcopyTask<T>> tasks;
+         for(typename QSTArray<T, 2, Q>::const_iterator ita = a.begin(); ita != a.end(); ++ita) {
+            int i = ita->first / a_stride;
+            int j = ita->first % a_stride;
+            std::map<int, int>::const_iterator isel = rows_select.index.find(i);
+            if(isel == rows_select.index.end()) continue;
+            int irow = isel->second;
+            int drow = rows_select.dshape[irow];
+            const typename remove_complex<T>::type* pscale = 0;
+            if(rows_scale) {
+               typename STArray<typename remove_complex<T>::type, 1>::const_iterator its = rows_scale->find(irow);
+               BTAS_THROW(its != rows_scale->end() && its->second->size() >= drow, "btas::QSTexpand: scaling array doesn't match selected rows");
+               pscale = its->second->data();
+            }
+            const TArray<T, 2>& block = *(ita->second);
+            int lda = block.shape(1);
+            // scatter cols
+            typename QSTmergeInfo<MC, Q>::const_range jcol_range = cols_info.equal_range(j);
+            int offset = 0;
+            for(typename QSTmergeInfo<MC, Q>::const_iterator itc = jcol_range.first; itc != jcol_range.second; ++itc) {
+               int jcol = itc->second;
+               int dcol = cols_info.dshape_packed(jcol);
+               if(dcol == 0) continue;
+               typename QSTArray<T, 1+MC, Q>::iterator itb = b.reserve(irow * b_stride + jcol);
+               if(itb != b.end()) {
+                  QSTcopyTask<T> task;
+                  task.dst  = itb->second->data();
+                  task.size = itb->second->size();
+                  task.add(block.data() + offset, lda, 0, dcol, drow, dcol, pscale, 0);
+                  tasks.push_back(task);
+               }
+               offset += dcol;
             }
          }
+         QSTcopy_parallel(tasks);
       }
 
 };
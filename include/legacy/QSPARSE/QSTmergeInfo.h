@@ -2,12 +2,34 @@
 #define _BTAS_CXX11_QSTMERGE_INFO_H 1
 
 #include <map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <unordered_map>
 
 #include <legacy/common/btas.h>
 #include <legacy/QSPARSE/Qshapes.h>
 
+//! Max. number of merge infos held in the interning cache for each rank and quantum number class
+#ifndef BTAS_QSTMERGE_CACHE_SIZE
+#define BTAS_QSTMERGE_CACHE_SIZE 1024
+#endif
+
 namespace btas {
 
+   //! Hash of quantum number, used for interning QSTmergeInfo
+   /*! Default hashes object representation, which is fine for quantum number classes consisting of integers.
+    *  Specialize this for quantum number classes having padding or pointers. */
+   template<class Q>
+      struct QSThash {
+         size_t operator() (const Q& q) const {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(&q);
+            size_t seed = 0;
+            for(size_t i = 0; i < sizeof(Q); ++i) seed = seed * 31 + p[i];
+            return seed;
+         }
+      };
+
    //! Merged index infomation by quantum number-based sparse array.
    /*!
     *  Provides reversible conversion of merged quantum number indices.
@@ -19,7 +41,11 @@ namespace btas {
     *  Then, packed indices are merged by quantum number
     *  e.g. {q1*q1, q1*q2, q2*q1, q2*q2} -> {q11, q12, q22}
     *
-    *  Multi-map m_index_map provides map from {q11, q12, q22} to {q1*q1, {q1*q2, q2*q1}, q2*q2}
+    *  Flat sorted array m_index_map provides map from {q11, q12, q22} to {q1*q1, {q1*q2, q2*q1}, q2*q2},
+    *  where packed indices for merged index i are stored in [m_index_offset[i], m_index_offset[i+1]).
+    *
+    *  Since the same index sets recur in DMRG sweeps, merge infos can be interned by intern(qshape, dshape),
+    *  so that they are built only once and shared.
     *
     */
 #ifdef _ENABLE_DEFAULT_QUANTUM
@@ -31,7 +57,7 @@ template<size_t N, class Q>
 
          public:
 
-            typedef typename std::multimap<int, int>::const_iterator const_iterator;
+            typedef typename std::vector<std::pair<int, int>>::const_iterator const_iterator;
             typedef typename std::pair<const_iterator, const_iterator> const_range;
 
          public:
@@ -73,11 +99,24 @@ template<size_t N, class Q>
                }
 
                // mapping packed index to merged index and computing merged block size
-               m_index_map.clear();
                Dshapes dshape_mgd(n, 0);
+               m_index_merged.resize(qshape_pkd.size());
+               m_index_offset.assign(n+1, 0);
                for(int i = 0; i < qshape_pkd.size(); ++i) {
                   int j = q_index_map.find(qshape_pkd[i])->second;
-                  m_index_map.insert(std::make_pair(j, i));
+                  m_index_merged[i] = j;
+                  ++m_index_offset[j+1];
+               }
+               for(int j = 0; j < n; ++j)
+                  m_index_offset[j+1] += m_index_offset[j];
+               // flat array sorted by merged index, packed indices are in ascending order for each merged index
+               m_index_map.resize(qshape_pkd.size());
+               m_offset_packed.resize(qshape_pkd.size());
+               std::vector<int> count(m_index_offset.begin(), m_index_offset.end()-1);
+               for(int i = 0; i < qshape_pkd.size(); ++i) {
+                  int j = m_index_merged[i];
+                  m_index_map[count[j]++] = std::make_pair(j, i);
+                  m_offset_packed[i] = dshape_mgd[j];
                   dshape_mgd[j] += dshape_pkd[i];
                }
                // save as members
@@ -89,6 +128,55 @@ template<size_t N, class Q>
                m_qshape_merged = qshape_mgd;
             }
 
+            //! Return shared merge info for given shapes, which is built only once
+            /*! Thread-safe. Cache is cleared when it exceeds BTAS_QSTMERGE_CACHE_SIZE entries. */
+            static shared_ptr<const QSTmergeInfo> intern (const TVector<Qshapes<Q>, N>& qshape, const TVector<Dshapes, N>& dshape) {
+               size_t key = hash(qshape, dshape);
+               shared_ptr<const QSTmergeInfo> info;
+#pragma omp critical(btas_QSTmergeInfo_cache)
+               {
+                  cache_type& cache = mf_cache();
+                  typename cache_type::const_iterator it = cache.find(key);
+                  for(; it != cache.end() && it->first == key; ++it) {
+                     if(it->second->m_qshape == qshape && it->second->m_dshape == dshape) {
+                        info = it->second;
+                        break;
+                     }
+                  }
+               }
+               if(info) return info;
+
+               // building merge info is done outside of critical section
+               shared_ptr<QSTmergeInfo> created(new QSTmergeInfo(qshape, dshape));
+#pragma omp critical(btas_QSTmergeInfo_cache)
+               {
+                  cache_type& cache = mf_cache();
+                  if(cache.size() >= BTAS_QSTMERGE_CACHE_SIZE) cache.clear();
+                  cache.insert(std::make_pair(key, created));
+               }
+               return created;
+            }
+
+            //! Clear interning cache
+            static void clear_cache () {
+#pragma omp critical(btas_QSTmergeInfo_cache)
+               mf_cache().clear();
+            }
+
+            //! Hash of shapes
+            static size_t hash (const TVector<Qshapes<Q>, N>& qshape, const TVector<Dshapes, N>& dshape) {
+               QSThash<Q> qhash;
+               size_t seed = N;
+               for(int i = 0; i < N; ++i) {
+                  seed ^= qshape[i].size() + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                  for(int k = 0; k < qshape[i].size(); ++k) {
+                     seed ^= qhash(qshape[i][k]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                     seed ^= static_cast<size_t>(dshape[i][k]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+                  }
+               }
+               return seed;
+            }
+
             const TVector<Dshapes, N>& dshape() const { return m_dshape; }
             const Dshapes& dshape(int i) const { return m_dshape[i]; }
 
@@ -104,14 +192,31 @@ template<size_t N, class Q>
             const Qshapes<Q>& qshape_merged() const { return m_qshape_merged; }
             const Q& qshape_merged(int i) const { return m_qshape_merged[i]; }
 
+            //! Merged index of packed index i
+            const int& index_merged(int i) const { return m_index_merged[i]; }
+
+            //! Offset of packed index i in merged block
+            const int& offset_packed(int i) const { return m_offset_packed[i]; }
+
             const_iterator begin() const { return m_index_map.begin(); }
             const_iterator end() const { return m_index_map.end(); }
-            const_iterator find(int i) const { return m_index_map.find(i); }
+            const_iterator find(int i) const {
+               if(i < 0 || i+1 >= m_index_offset.size() || m_index_offset[i] == m_index_offset[i+1]) return m_index_map.end();
+               return m_index_map.begin() + m_index_offset[i];
+            }
 
-            const_range equal_range(int i) const { return m_index_map.equal_range(i); }
+            const_range equal_range(int i) const {
+               if(i < 0 || i+1 >= m_index_offset.size()) return std::make_pair(m_index_map.end(), m_index_map.end());
+               return std::make_pair(m_index_map.begin() + m_index_offset[i], m_index_map.begin() + m_index_offset[i+1]);
+            }
 
          private:
 
+            typedef std::unordered_multimap<size_t, shared_ptr<const QSTmergeInfo>> cache_type;
+
+            //! Interning cache
+            static cache_type& mf_cache() { static cache_type cache; return cache; }
+
             //! Original dense shapes
             TVector<Dshapes, N> m_dshape;
 
@@ -127,8 +232,17 @@ template<size_t N, class Q>
             //! Merged quantum number indices
             Qshapes<Q> m_qshape_merged;
 
-            //! Map from merged index to packed indices
-            std::multimap<int, int> m_index_map;
+            //! Map from merged index to packed indices, sorted by merged index
+            std::vector<std::pair<int, int>> m_index_map;
+
+            //! Offsets of m_index_map for each merged index
+            std::vector<int> m_index_offset;
+
+            //! Merged index for each packed index
+            std::vector<int> m_index_merged;
+
+            //! Offset in merged block for each packed index
+            std::vector<int> m_offset_packed;
 
       };
 
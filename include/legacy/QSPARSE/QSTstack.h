@@ -0,0 +1,148 @@
+#ifndef __BTAS_QSPARSE_QSTSTACK_H
+#define __BTAS_QSPARSE_QSTSTACK_H 1
+
+#include <vector>
+#include <algorithm>
+
+#include <legacy/common/btas.h>
+#include <legacy/common/TVector.h>
+
+#include <legacy/QSPARSE/QSTArray.h>
+#include <legacy/QSPARSE/QSTmerge.h>
+
+namespace btas
+{
+
+//! Stack arrays x[0], ..., x[k-1] along batch index inserted at position P, to give y
+/*! All arrays must have the same quantum number and shapes.
+ *  Batch index has single quantum number, Q::zero(), of dimension k, thus y has the same non-zero blocks as x,
+ *  and a contraction on y, over the other indices, gives k results at once by wider matrix multiplications.
+ *
+ *  E.g.) P = N : y(i, j, b) = x[b](i, j)
+ */
+template<size_t P, typename T, size_t N, class Q>
+void QSTstack (const std::vector<QSTArray<T, N, Q>>& x, QSTArray<T, N+1, Q>& y)
+{
+   static_assert(P <= N, "btas::QSTstack: batch index position is out of range");
+   BTAS_THROW(!x.empty(), "btas::QSTstack: no array to be stacked");
+
+   const int k = x.size();
+   for(int b = 1; b < k; ++b) {
+      BTAS_THROW(x[b].q() == x[0].q(), "btas::QSTstack: total quantum numbers mismatched");
+      BTAS_THROW(x[b].qshape() == x[0].qshape(), "btas::QSTstack: quantum number indices mismatched");
+   }
+
+   TVector<Qshapes<Q>, N+1> y_qshape;
+   TVector<Dshapes,    N+1> y_dshape;
+   for(int i = 0, j = 0; i <= N; ++i) {
+      if(i == P) {
+         y_qshape[i] = Qshapes<Q>(1, Q::zero());
+         y_dshape[i] = Dshapes(1, k);
+      }
+      else {
+         y_qshape[i] = x[0].qshape(j);
+         y_dshape[i] = x[0].dshape(j);
+         ++j;
+      }
+   }
+   y.clear();
+   y.resize(x[0].q(), y_qshape, y_dshape, false);
+
+   // non-zero blocks of y, as union of those of x's
+   std::vector<int> tags;
+   for(int b = 0; b < k; ++b)
+      for(auto it = x[b].begin(); it != x[b].end(); ++it) tags.push_back(it->first);
+   std::sort(tags.begin(), tags.end());
+   tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+
+   std::vector<T*> y_ptrs(tags.size());
+   std::vector<int> y_pre (tags.size());
+   std::vector<int> y_post(tags.size());
+   for(int t = 0; t < tags.size(); ++t) {
+      const IVector<N>& x_index = x[0].index(tags[t]);
+      IVector<N+1> y_index;
+      for(int i = 0, j = 0; i <= N; ++i) y_index[i] = (i == P) ? 0 : x_index[j++];
+      auto ib = y.reserve(y_index);
+      y_ptrs[t] = ib->second->data();
+      const IVector<N+1>& shape = ib->second->shape();
+      int pre = 1; for(int i = 0; i < P; ++i) pre *= shape[i];
+      int post = 1; for(int i = P+1; i <= N; ++i) post *= shape[i];
+      y_pre [t] = pre;
+      y_post[t] = post;
+   }
+
+   // y(pre, b, post) = x[b](pre, post)
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(int t = 0; t < tags.size(); ++t) {
+      for(int b = 0; b < k; ++b) {
+         auto ix = x[b].find(tags[t]);
+         if(ix != x[b].end())
+            QSTcopy2d(y_pre[t], y_post[t], ix->second->data(), y_post[t], y_ptrs[t]+b*y_post[t], k*y_post[t]);
+         else
+            for(int r = 0; r < y_pre[t]; ++r)
+               std::fill_n(y_ptrs[t]+(r*k+b)*y_post[t], y_post[t], static_cast<T>(0));
+      }
+   }
+}
+
+//! Split y along batch index at position P into x[0], ..., x[k-1], i.e. inverse of QSTstack
+/*! Batch index must have single quantum number, Q::zero(). Arrays in x are overwritten. */
+template<size_t P, typename T, size_t N, class Q>
+void QSTunstack (const QSTArray<T, N+1, Q>& y, std::vector<QSTArray<T, N, Q>>& x)
+{
+   static_assert(P <= N, "btas::QSTunstack: batch index position is out of range");
+   BTAS_THROW(y.qshape(P).size() == 1 && y.qshape(P)[0] == Q::zero(), "btas::QSTunstack: batch index must have zero quantum number");
+
+   const int k = y.dshape(P)[0];
+
+   TVector<Qshapes<Q>, N> x_qshape;
+   TVector<Dshapes,    N> x_dshape;
+   for(int i = 0, j = 0; i <= N; ++i) {
+      if(i == P) continue;
+      x_qshape[j] = y.qshape(i);
+      x_dshape[j] = y.dshape(i);
+      ++j;
+   }
+   x.resize(k);
+   for(int b = 0; b < k; ++b) {
+      x[b].clear();
+      x[b].resize(y.q(), x_qshape, x_dshape, false);
+   }
+
+   // allocation is done serially, since it modifies std::map
+   std::vector<const T*> y_ptrs;
+   std::vector<std::vector<T*>> x_ptrs;
+   std::vector<int> y_pre;
+   std::vector<int> y_post;
+   y_ptrs.reserve(y.nnz());
+   x_ptrs.reserve(y.nnz());
+   for(auto it = y.begin(); it != y.end(); ++it) {
+      const IVector<N+1>& y_index = y.index(it->first);
+      IVector<N> x_index;
+      for(int i = 0, j = 0; i <= N; ++i) if(i != P) x_index[j++] = y_index[i];
+      std::vector<T*> ptrs(k);
+      for(int b = 0; b < k; ++b) ptrs[b] = x[b].reserve(x_index)->second->data();
+      const IVector<N+1>& shape = it->second->shape();
+      int pre = 1; for(int i = 0; i < P; ++i) pre *= shape[i];
+      int post = 1; for(int i = P+1; i <= N; ++i) post *= shape[i];
+      y_ptrs.push_back(it->second->data());
+      x_ptrs.push_back(ptrs);
+      y_pre .push_back(pre);
+      y_post.push_back(post);
+   }
+
+   // x[b](pre, post) = y(pre, b, post)
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+   for(int t = 0; t < y_ptrs.size(); ++t) {
+      for(int b = 0; b < k; ++b)
+         QSTcopy2d(y_pre[t], y_post[t], y_ptrs[t]+b*y_post[t], k*y_post[t], x_ptrs[t][b], y_post[t]);
+   }
+}
+
+}; // namespace btas
+
+#endif // __BTAS_QSPARSE_QSTSTACK_H
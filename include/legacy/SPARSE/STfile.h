@@ -0,0 +1,371 @@
+#ifndef __BTAS_SPARSE_STFILE_H
+#define __BTAS_SPARSE_STFILE_H 1
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <legacy/common/btas.h>
+#include <legacy/common/TVector.h>
+
+#include <legacy/SPARSE/STArray.h>
+
+namespace btas
+{
+
+//  ====================================================================================================
+//  Binary file format of block-sparse array, version 1
+//
+//  [header]        STfileHeader, 64 bytes
+//  [shape]         for each rank i : uint64 n(i), int32 dshape(i)[n(i)]
+//  [extra]         opaque bytes, e.g. quantum numbers written by QSTsave
+//  [block table]   STfileEntry[nnz], 8-byte aligned, sorted by tag
+//  [payload]       raw block elements in row-major order, each of them is 64-byte aligned
+//
+//  Numbers are written in native byte order, which is checked by reader.
+//  ====================================================================================================
+
+#define BTAS_STFILE_VERSION 1
+
+#define BTAS_STFILE_ALIGN 64
+
+/// File header
+struct STfileHeader
+{
+   char     magic[8];      ///< "BTASSTF"
+   uint32_t version;       ///< BTAS_STFILE_VERSION
+   uint32_t byte_order;    ///< 0x01020304 in native byte order
+   uint32_t rank;          ///< rank of array
+   uint32_t value_size;    ///< sizeof(T)
+   uint64_t nnz;           ///< number of non-zero blocks
+   uint64_t extra_offset;  ///< offset of extra section
+   uint64_t extra_size;    ///< size of extra section in bytes
+   uint64_t table_offset;  ///< offset of block table
+   uint64_t reserved;
+};
+
+static_assert(sizeof(STfileHeader) == 64, "btas::STfileHeader must be 64 bytes");
+
+/// Entry of block table
+struct STfileEntry
+{
+   int64_t  tag;           ///< block tag
+   uint64_t offset;        ///< offset of block elements from the beginning of file
+   uint64_t size;          ///< number of elements
+};
+
+inline uint64_t __ST_file_align (uint64_t offset, uint64_t align) { return (offset + align - 1) / align * align; }
+
+/// Write block-sparse array to file
+/// Blocks are streamed from their own storages, without intermediate buffer.
+/// \param extra opaque bytes stored in the file, which can be read by STmappedFile::extra()
+template<typename T, size_t N>
+void STsave (const STArray<T, N>& x, const std::string& fname, const std::vector<char>& extra = std::vector<char>())
+{
+   const TVector<Dshapes, N>& dshape = x.dshape();
+
+   // layout
+   uint64_t offset = sizeof(STfileHeader);
+   for(int i = 0; i < N; ++i) offset += sizeof(uint64_t) + sizeof(int32_t) * dshape[i].size();
+
+   STfileHeader header;
+   std::memset(&header, 0, sizeof(header));
+   std::strncpy(header.magic, "BTASSTF", sizeof(header.magic));
+   header.version      = BTAS_STFILE_VERSION;
+   header.byte_order   = 0x01020304;
+   header.rank         = N;
+   header.value_size   = sizeof(T);
+   header.nnz          = x.nnz();
+   header.extra_offset = offset;
+   header.extra_size   = extra.size();
+   header.table_offset = __ST_file_align(offset + extra.size(), 8);
+
+   std::vector<STfileEntry> table;
+   table.reserve(x.nnz());
+   offset = __ST_file_align(header.table_offset + sizeof(STfileEntry) * x.nnz(), BTAS_STFILE_ALIGN);
+   for(auto it = x.begin(); it != x.end(); ++it) {
+      STfileEntry entry;
+      entry.tag    = it->first;
+      entry.offset = offset;
+      entry.size   = it->second->size();
+      table.push_back(entry);
+      offset = __ST_file_align(offset + sizeof(T) * entry.size, BTAS_STFILE_ALIGN);
+   }
+
+   // stream
+   std::ofstream fout(fname.c_str(), std::ios::binary | std::ios::trunc);
+   BTAS_THROW(fout.good(), "btas::STsave: failed to open file");
+
+   uint64_t pos = 0;
+   const char zeros[BTAS_STFILE_ALIGN] = { 0 };
+   auto pad_to = [&fout, &pos, &zeros] (uint64_t target) {
+      while(pos < target) {
+         uint64_t n = std::min<uint64_t>(target - pos, BTAS_STFILE_ALIGN);
+         fout.write(zeros, n);
+         pos += n;
+      }
+   };
+
+   fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+   pos += sizeof(header);
+   for(int i = 0; i < N; ++i) {
+      uint64_t n = dshape[i].size();
+      fout.write(reinterpret_cast<const char*>(&n), sizeof(n));
+      std::vector<int32_t> d(dshape[i].begin(), dshape[i].end());
+      fout.write(reinterpret_cast<const char*>(d.data()), sizeof(int32_t) * n);
+      pos += sizeof(n) + sizeof(int32_t) * n;
+   }
+   fout.write(extra.data(), extra.size());
+   pos += extra.size();
+
+   pad_to(header.table_offset);
+   fout.write(reinterpret_cast<const char*>(table.data()), sizeof(STfileEntry) * table.size());
+   pos += sizeof(STfileEntry) * table.size();
+
+   int k = 0;
+   for(auto it = x.begin(); it != x.end(); ++it, ++k) {
+      pad_to(table[k].offset);
+      fout.write(reinterpret_cast<const char*>(it->second->data()), sizeof(T) * table[k].size);
+      pos += sizeof(T) * table[k].size;
+   }
+
+   BTAS_THROW(fout.good(), "btas::STsave: failed to write file");
+}
+
+/// Read-only view of block in mapped file
+template<typename T, size_t N>
+struct STblockView
+{
+   int        tag;   ///< block tag
+   IVector<N> shape; ///< block shape
+   const T*   data;  ///< pointer to elements in mapped memory
+   size_t     size;  ///< number of elements
+};
+
+/// Memory-mapped reader of block-sparse array file
+/// Blocks are exposed as views to mapped memory, and are read from disk only when they're touched,
+/// so that a part of array can be loaded without reading whole file.
+/// Views are valid while this object is alive.
+template<typename T, size_t N>
+class STmappedFile
+{
+public:
+
+   typedef typename std::vector<STblockView<T, N>>::const_iterator const_iterator;
+
+   /// Map file
+   explicit STmappedFile (const std::string& fname)
+   : m_addr (0), m_size (0)
+   {
+      int fd = ::open(fname.c_str(), O_RDONLY);
+      BTAS_THROW(fd >= 0, "btas::STmappedFile: failed to open file");
+      struct stat st;
+      if(::fstat(fd, &st) != 0) {
+         ::close(fd);
+         BTAS_THROW(false, "btas::STmappedFile: failed to stat file");
+      }
+      m_size = st.st_size;
+      if(m_size >= sizeof(STfileHeader))
+         m_addr = ::mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      BTAS_THROW(m_size >= sizeof(STfileHeader), "btas::STmappedFile: file is too short");
+      BTAS_THROW(m_addr != MAP_FAILED, "btas::STmappedFile: failed to map file");
+      try {
+         mf_parse();
+      }
+      catch(...) {
+         ::munmap(m_addr, m_size);
+         m_addr = 0;
+         throw;
+      }
+   }
+
+   /// Unmap file
+  ~STmappedFile ()
+   {
+      if(m_addr && m_addr != MAP_FAILED) ::munmap(m_addr, m_size);
+   }
+
+   /// Returns dense shapes
+   const TVector<Dshapes, N>& dshape () const { return m_dshape; }
+
+   /// Number of non-zero blocks
+   size_t nnz () const { return m_blocks.size(); }
+
+   const_iterator begin () const { return m_blocks.begin(); }
+
+   const_iterator end () const { return m_blocks.end(); }
+
+   /// Find block by tag, returns end() if not found
+   const_iterator find (int tag) const
+   {
+      auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), tag,
+                                 [] (const STblockView<T, N>& b, int t) { return b.tag < t; });
+      return (it != m_blocks.end() && it->tag == tag) ? it : m_blocks.end();
+   }
+
+   /// Extra bytes stored in file
+   const char* extra () const { return m_extra; }
+
+   /// Size of extra bytes
+   size_t extra_size () const { return m_extra_size; }
+
+   /// Advise kernel to read all blocks ahead
+   void willneed () const { ::madvise(m_addr, m_size, MADV_WILLNEED); }
+
+   /// Load whole array
+   void load (STArray<T, N>& x) const
+   {
+      x.clear();
+      x.resize(m_dshape, false);
+      std::vector<const STblockView<T, N>*> blocks;
+      blocks.reserve(m_blocks.size());
+      for(auto ib = m_blocks.begin(); ib != m_blocks.end(); ++ib) blocks.push_back(&(*ib));
+      mf_load_blocks(blocks, x);
+   }
+
+   /// Load blocks specified by tags, which are not in file are skipped
+   void load (STArray<T, N>& x, const std::vector<int>& tags) const
+   {
+      x.clear();
+      x.resize(m_dshape, false);
+      mf_load_blocks(mf_find_blocks(tags), x);
+   }
+
+protected:
+
+   /// Find blocks by tags
+   std::vector<const STblockView<T, N>*> mf_find_blocks (const std::vector<int>& tags) const
+   {
+      std::vector<const STblockView<T, N>*> blocks;
+      for(int k = 0; k < tags.size(); ++k) {
+         auto ib = find(tags[k]);
+         if(ib != m_blocks.end()) blocks.push_back(&(*ib));
+      }
+      return blocks;
+   }
+
+   /// Copy blocks into x, which has been resized
+   /// Blocks are allocated serially, since it modifies std::map, and are copied in parallel.
+   void mf_load_blocks (const std::vector<const STblockView<T, N>*>& blocks, STArray<T, N>& x) const
+   {
+      std::vector<T*> ptrs(blocks.size());
+      for(int k = 0; k < blocks.size(); ++k) {
+         auto it = x.reserve(blocks[k]->tag);
+         BTAS_THROW(it != x.end(), "btas::STmappedFile: block in file is not allowed in array");
+         ptrs[k] = it->second->data();
+      }
+#ifndef _SERIAL
+#pragma omp parallel for schedule(guided)
+#endif
+      for(int k = 0; k < blocks.size(); ++k)
+         std::copy(blocks[k]->data, blocks[k]->data + blocks[k]->size, ptrs[k]);
+   }
+
+private:
+
+   /// True if bytes from offset are in file
+   bool mf_fits (uint64_t offset, uint64_t bytes) const { return offset <= m_size && bytes <= m_size - offset; }
+
+   /// Header is not trusted, every offset and size is checked against file and shapes before use
+   void mf_parse ()
+   {
+      const char* base = static_cast<const char*>(m_addr);
+      STfileHeader header;
+      std::memcpy(&header, base, sizeof(header));
+      BTAS_THROW(std::strncmp(header.magic, "BTASSTF", sizeof(header.magic)) == 0, "btas::STmappedFile: not a block-sparse array file");
+      BTAS_THROW(header.byte_order == 0x01020304, "btas::STmappedFile: byte order mismatched");
+      BTAS_THROW(header.version == BTAS_STFILE_VERSION, "btas::STmappedFile: unsupported file version");
+      BTAS_THROW(header.rank == N, "btas::STmappedFile: array rank mismatched");
+      BTAS_THROW(header.value_size == sizeof(T), "btas::STmappedFile: value type mismatched");
+      BTAS_THROW(mf_fits(header.extra_offset, header.extra_size), "btas::STmappedFile: file is truncated");
+      BTAS_THROW(header.nnz <= (m_size - std::min<uint64_t>(header.table_offset, m_size)) / sizeof(STfileEntry)
+              && mf_fits(header.table_offset, sizeof(STfileEntry) * header.nnz), "btas::STmappedFile: file is truncated");
+
+      // dense shapes and sparse strides
+      uint64_t offset = sizeof(STfileHeader);
+      IVector<N> sshape;
+      uint64_t nblocks = 1;
+      for(int i = 0; i < N; ++i) {
+         uint64_t n;
+         BTAS_THROW(mf_fits(offset, sizeof(n)), "btas::STmappedFile: file is truncated");
+         std::memcpy(&n, base + offset, sizeof(n));
+         offset += sizeof(n);
+         BTAS_THROW(n <= (m_size - offset) / sizeof(int32_t), "btas::STmappedFile: file is truncated");
+         std::vector<int32_t> d(n);
+         std::memcpy(d.data(), base + offset, sizeof(int32_t) * n);
+         offset += sizeof(int32_t) * n;
+         for(size_t k = 0; k < n; ++k) BTAS_THROW(d[k] >= 0, "btas::STmappedFile: negative dense shape");
+         m_dshape[i].assign(d.begin(), d.end());
+         sshape[i] = n;
+         nblocks *= n;
+         BTAS_THROW(nblocks <= static_cast<uint64_t>(std::numeric_limits<int>::max()), "btas::STmappedFile: sparse shape is too large");
+      }
+      IVector<N> sstride;
+      int stride = 1;
+      for(int i = N-1; i >= 0; --i) { sstride[i] = stride; stride *= sshape[i]; }
+
+      m_extra      = base + header.extra_offset;
+      m_extra_size = header.extra_size;
+
+      // block views, which must be sorted by tag for find()
+      m_blocks.resize(header.nnz);
+      const STfileEntry* table = reinterpret_cast<const STfileEntry*>(base + header.table_offset);
+      for(size_t k = 0; k < header.nnz; ++k) {
+         STfileEntry entry;
+         std::memcpy(&entry, table + k, sizeof(entry));
+         BTAS_THROW(entry.tag >= 0 && static_cast<uint64_t>(entry.tag) < nblocks, "btas::STmappedFile: block tag is out of range");
+         BTAS_THROW(k == 0 || m_blocks[k-1].tag < entry.tag, "btas::STmappedFile: block table is not sorted");
+         BTAS_THROW(entry.size <= (m_size - std::min<uint64_t>(entry.offset, m_size)) / sizeof(T), "btas::STmappedFile: file is truncated");
+         STblockView<T, N>& b = m_blocks[k];
+         b.tag  = entry.tag;
+         b.data = reinterpret_cast<const T*>(base + entry.offset);
+         b.size = entry.size;
+         int tag = entry.tag;
+         uint64_t size = 1;
+         for(int i = 0; i < N; ++i) {
+            b.shape[i] = m_dshape[i][tag / sstride[i]];
+            tag %= sstride[i];
+            size *= b.shape[i];
+         }
+         BTAS_THROW(entry.size == size, "btas::STmappedFile: block size mismatched with dense shape");
+      }
+   }
+
+   void* m_addr;
+
+   size_t m_size;
+
+   const char* m_extra;
+
+   size_t m_extra_size;
+
+   TVector<Dshapes, N> m_dshape;
+
+   std::vector<STblockView<T, N>> m_blocks;
+
+   STmappedFile (const STmappedFile&);
+   STmappedFile& operator= (const STmappedFile&);
+};
+
+/// Load block-sparse array from file
+template<typename T, size_t N>
+void STload (const std::string& fname, STArray<T, N>& x)
+{
+   STmappedFile<T, N> file(fname);
+   file.willneed();
+   file.load(x);
+}
+
+}; // namespace btas
+
+#endif // __BTAS_SPARSE_STFILE_H
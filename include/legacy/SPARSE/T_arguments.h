@@ -348,7 +348,12 @@ struct Gesvd_arguments
    char jobu_;
    char jobvt_;
 
-   Gesvd_arguments () : jobu_ ('S'), jobvt_ ('S') { }
+   BTAS_SVD_DRIVER driver_;
+
+   Gesvd_arguments () : jobu_ ('S'), jobvt_ ('S'), driver_ (SvdAuto) { }
+
+   explicit
+   Gesvd_arguments (const BTAS_SVD_DRIVER& driver) : jobu_ ('S'), jobvt_ ('S'), driver_ (driver) { }
 
    Gesvd_arguments (
       const char& jobu,
@@ -360,7 +365,8 @@ struct Gesvd_arguments
    :  T_arguments_base (a->size()),
       R_arguments_base<TArray<T, N>, TArray<U, 1>, TArray<T, K>, TArray<T, L>>(a, s, u, vt),
       jobu_ (jobu),
-      jobvt_ (jobvt)
+      jobvt_ (jobvt),
+      driver_ (SvdAuto)
    { }
 
    void reset (
@@ -380,7 +386,70 @@ struct Gesvd_arguments
       jobvt_ = jobvt;
    }
 
-   void call () const { Gesvd(jobu_, jobvt_, *get<0>(*this), *get<1>(*this), *get<2>(*this), *get<3>(*this)); }
+   void call () const { Gesvd(jobu_, jobvt_, *get<0>(*this), *get<1>(*this), *get<2>(*this), *get<3>(*this), driver_); }
+};
+
+/// Arguments for randomized truncated SVD of matrix
+/// jobu and jobvt are ignored, since only leading singular vectors are computed
+template<typename T>
+struct Gesvd_random_arguments : public Gesvd_arguments<T, 2, 2>
+{
+   size_t rank_;
+   size_t n_over_;
+   size_t n_iter_;
+
+   /// Squared norm which is not represented by returned singular values, set by call()
+   mutable typename remove_complex<T>::type tail_;
+
+   Gesvd_random_arguments (const size_t& rank = 0, const size_t& n_over = 10, const size_t& n_iter = 2)
+   :  rank_ (rank), n_over_ (n_over), n_iter_ (n_iter), tail_ (0)
+   { }
+
+   void call () const { tail_ = Gesvd_random(*get<0>(*this), *get<1>(*this), *get<2>(*this), *get<3>(*this), rank_, n_over_, n_iter_); }
+
+   typename remove_complex<T>::type tail () const { return tail_; }
+};
+
+/// Arguments list for thin QR decomposition
+template<typename T, size_t N, size_t K>
+struct Geqrf_arguments
+:  public T_arguments_base,
+   public R_arguments_base<TArray<T, N>, TArray<T, K>, TArray<T, N-K+2>>
+{
+   static const size_t L = N-K+2;
+
+   Geqrf_arguments () { }
+
+   Geqrf_arguments (
+      const shared_ptr<TArray<T, N>>& a,
+      const shared_ptr<TArray<T, K>>& q,
+      const shared_ptr<TArray<T, L>>& r)
+   :  T_arguments_base (a->size()),
+      R_arguments_base<TArray<T, N>, TArray<T, K>, TArray<T, L>>(a, q, r)
+   { }
+
+   void call () const { Geqrf(*get<0>(*this), *get<1>(*this), *get<2>(*this)); }
+};
+
+/// Arguments list for thin LQ decomposition
+template<typename T, size_t N, size_t K>
+struct Gelqf_arguments
+:  public T_arguments_base,
+   public R_arguments_base<TArray<T, N>, TArray<T, K>, TArray<T, N-K+2>>
+{
+   static const size_t L = N-K+2;
+
+   Gelqf_arguments () { }
+
+   Gelqf_arguments (
+      const shared_ptr<TArray<T, N>>& a,
+      const shared_ptr<TArray<T, K>>& l,
+      const shared_ptr<TArray<T, L>>& q)
+   :  T_arguments_base (a->size()),
+      R_arguments_base<TArray<T, N>, TArray<T, K>, TArray<T, L>>(a, l, q)
+   { }
+
+   void call () const { Gelqf(*get<0>(*this), *get<1>(*this), *get<2>(*this)); }
 };
 
 //
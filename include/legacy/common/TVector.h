@@ -24,22 +24,9 @@
 #if BOOST_VERSION / 100 % 100 > 64
 
 #include <array>
-
-namespace boost {
-namespace serialization {
-
-//####################################################################################################
-// Boost serialization for std::array
-//####################################################################################################
-
-//! Enables to use boost serialization
-template<class Archive, typename T, size_t N>
-void serialize(Archive& ar, std::array<T, N>& vec, const unsigned int version) {
-  for(size_t i = 0; i < N; ++i) ar & vec[i];
-}
-
-}; // namespace serialization
-}; // namespace boost
+// serialization for std::array is provided by boost, and must not be redefined here,
+// otherwise it conflicts with boost headers which include it (e.g. boost/mpi.hpp)
+#include <boost/serialization/array.hpp>
 
 #else
 
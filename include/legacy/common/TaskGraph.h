@@ -0,0 +1,158 @@
+//
+/*! \file TaskGraph.h
+ *  \brief Dependency-graph executor, which runs independent tasks concurrently on a thread pool.
+ *
+ *  Tasks are added with the tasks they depend on, which must have been added before,
+ *  thus the graph is acyclic and the order of addition is a valid serial order.
+ *
+ *  E.g.) a DMRG step, where the guess and the renormalization only depend on the decomposition
+ *
+ *    TaskGraph step;
+ *    TaskGraph::Task svd = step.add([&] { Canonicalize(...); }, {}, true);
+ *    step.add([&] { ComputeGuess(...); }, { svd });
+ *    step.add([&] { Renormalize (...); }, { svd }, true);
+ *    step.run();
+ */
+
+#ifndef _BTAS_CXX11_TASKGRAPH_H
+#define _BTAS_CXX11_TASKGRAPH_H 1
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <utility>
+
+#include <legacy/common/btas.h>
+#include <legacy/common/ThreadPool.h>
+
+namespace btas {
+
+class TaskGraph {
+public:
+  typedef size_t Task;
+
+  //! Add task f which runs after deps
+  /*! \param on_caller if true, f runs on the thread which calls run(), in order of addition among such tasks.
+   *         It must be set for tasks with collective communication, which must be called in the same order on every process.
+   *  \return handle to be used as dependency of later tasks */
+  Task add(std::function<void()> f, const std::vector<Task>& deps = std::vector<Task>(), bool on_caller = false)
+  {
+    Task t = m_nodes.size();
+    Node node;
+    node.f = std::move(f);
+    node.ndeps = deps.size();
+    node.on_caller = on_caller;
+    for(auto d = deps.begin(); d != deps.end(); ++d) {
+      BTAS_THROW(*d < t, "btas::TaskGraph::add: task depends on a task which is not added yet");
+      m_nodes[*d].next.push_back(t);
+    }
+    m_nodes.push_back(std::move(node));
+    return t;
+  }
+
+  //! Number of tasks
+  size_t size() const { return m_nodes.size(); }
+
+  void clear() { m_nodes.clear(); }
+
+  //! Run all tasks, and wait for them
+  /*! Tasks are submitted to pool as soon as their dependencies are done, while the calling thread runs on_caller tasks.
+   *  If pool is null, tasks run on the calling thread in order of addition.
+   *  If a task throws, no more task is started, and the first exception is re-thrown after running tasks are done.
+   *  The graph is kept, and can be run again. */
+  void run(ThreadPool* pool = &ThreadPool::shared())
+  {
+    if(!pool) {
+      for(auto it = m_nodes.begin(); it != m_nodes.end(); ++it) it->f();
+      return;
+    }
+
+    std::vector<size_t> ndeps(m_nodes.size());
+    for(Task t = 0; t < m_nodes.size(); ++t) ndeps[t] = m_nodes[t].ndeps;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::pair<Task, std::exception_ptr>> finished; // by pool, guarded by mtx
+    std::vector<Task> callers;                                 // on_caller tasks in order of addition
+    std::vector<bool> ready(m_nodes.size(), false);            // on_caller tasks of which dependencies are done
+    size_t icaller = 0;
+    std::exception_ptr error;
+    size_t nflight = 0;
+
+    for(Task t = 0; t < m_nodes.size(); ++t)
+      if(m_nodes[t].on_caller) callers.push_back(t);
+
+    auto schedule = [&] (Task t) {
+      if(m_nodes[t].on_caller) {
+        ready[t] = true;
+        return;
+      }
+      ++nflight;
+      const std::function<void()>& f = m_nodes[t].f;
+      pool->submit([&, t] {
+        std::exception_ptr e;
+        try { f(); } catch(...) { e = std::current_exception(); }
+        std::lock_guard<std::mutex> lock(mtx);
+        finished.push_back(std::make_pair(t, e));
+        cv.notify_one();
+      });
+    };
+    auto release = [&] (Task t) {
+      const std::vector<Task>& next = m_nodes[t].next;
+      for(auto it = next.begin(); it != next.end(); ++it)
+        if(--ndeps[*it] == 0) schedule(*it);
+    };
+    auto done = [&] (Task t, std::exception_ptr e) {
+      if(e && !error) error = e;
+      if(!error) release(t);
+    };
+
+    for(Task t = 0; t < m_nodes.size(); ++t)
+      if(ndeps[t] == 0) schedule(t);
+
+    // on_caller tasks are run strictly in order of addition, even if a later one gets ready first,
+    // s.t. the order doesn't depend on timing of pool tasks. Since the order of addition is a valid serial order,
+    // dependencies of the next one are either done or in flight.
+    auto runnable = [&] { return !error && icaller < callers.size() && ready[callers[icaller]]; };
+
+    while(true) {
+      std::vector<std::pair<Task, std::exception_ptr>> local;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        // wait only if there's nothing to be done on this thread
+        if(nflight > 0 && !runnable()) cv.wait(lock, [&] { return !finished.empty(); });
+        local.swap(finished);
+      }
+      for(auto it = local.begin(); it != local.end(); ++it) {
+        --nflight;
+        done(it->first, it->second);
+      }
+      if(runnable()) {
+        Task t = callers[icaller++];
+        std::exception_ptr e;
+        try { m_nodes[t].f(); } catch(...) { e = std::current_exception(); }
+        done(t, e);
+        continue;
+      }
+      if(nflight == 0) break;
+    }
+
+    if(error) std::rethrow_exception(error);
+  }
+
+private:
+  struct Node {
+    std::function<void()> f;
+    std::vector<Task> next;  //!< tasks which depend on this
+    size_t ndeps;            //!< number of dependencies
+    bool on_caller;
+  };
+
+  std::vector<Node> m_nodes;
+};
+
+}; // namespace btas
+
+#endif // _BTAS_CXX11_TASKGRAPH_H
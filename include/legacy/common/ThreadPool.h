@@ -0,0 +1,133 @@
+//
+/*! \file ThreadPool.h
+ *  \brief Fixed-size thread pool, on which asynchronous array operations are run.
+ *
+ *  A task is a callable without argument, and its result (or exception) is returned through std::future.
+ *  Tasks are typically contractions which are parallelized by OpenMP inside,
+ *  thus a small number of workers is enough to overlap independent ones.
+ *
+ *  Each worker sets its own number of OpenMP threads, by default omp_get_max_threads() of the constructing thread
+ *  divided by the number of workers, s.t. busy workers don't oversubscribe the cores.
+ *  The calling thread keeps its own setting, thus while it runs OpenMP regions concurrently (e.g. on_caller tasks of TaskGraph),
+ *  the total number of threads is up to twice the number of cores.
+ */
+
+#ifndef _BTAS_CXX11_THREADPOOL_H
+#define _BTAS_CXX11_THREADPOOL_H 1
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <cstdlib>
+#include <type_traits>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <legacy/common/btas.h>
+
+namespace btas {
+
+class ThreadPool {
+public:
+  //! Start nthreads workers, each of which runs OpenMP regions with omp_threads, or the default if it's not positive
+  explicit ThreadPool(int nthreads, int omp_threads = 0) : m_stop(false)
+  {
+    BTAS_THROW(nthreads > 0, "btas::ThreadPool: number of threads must be positive");
+#ifdef _OPENMP
+    if(omp_threads <= 0) omp_threads = std::max(1, omp_get_max_threads() / nthreads);
+#endif
+    for(int i = 0; i < nthreads; ++i) m_workers.push_back(std::thread([this, omp_threads] { mf_worker(omp_threads); }));
+  }
+
+  //! Queued tasks are done before workers are joined
+ ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    for(auto it = m_workers.begin(); it != m_workers.end(); ++it) it->join();
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator= (const ThreadPool&) = delete;
+
+  //! Queue task f, and return the future of its result
+  /*! Unlike std::async, the future doesn't block on destruction, thus it can be dropped if the result is not needed.
+   */
+  template<class F>
+  std::future<typename std::result_of<F()>::type> submit(F f)
+  {
+    typedef typename std::result_of<F()>::type R;
+    std::shared_ptr<std::packaged_task<R()>> task(new std::packaged_task<R()>(std::move(f)));
+    std::future<R> result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      BTAS_THROW(!m_stop, "btas::ThreadPool::submit: pool has been stopped");
+      m_queue.push_back([task] { (*task)(); });
+    }
+    m_cv.notify_one();
+    return result;
+  }
+
+  //! Number of workers
+  int size() const { return m_workers.size(); }
+
+  //! Pool shared by asynchronous operations, of which size is given by environment variable BTAS_ASYNC_THREADS (default 2)
+  /*! Number of OpenMP threads of each worker can be given by BTAS_ASYNC_OMP_THREADS. */
+  static ThreadPool& shared()
+  {
+    static ThreadPool pool(mf_shared_size("BTAS_ASYNC_THREADS", 2), mf_shared_size("BTAS_ASYNC_OMP_THREADS", 0));
+    return pool;
+  }
+
+private:
+  void mf_worker(int omp_threads)
+  {
+#ifdef _OPENMP
+    // ICVs are per thread, thus this doesn't affect the caller
+    omp_set_num_threads(omp_threads);
+#endif
+    while(true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if(m_queue.empty()) return;
+        task = std::move(m_queue.front());
+        m_queue.pop_front();
+      }
+      task();
+    }
+  }
+
+  static int mf_shared_size(const char* name, int n_default)
+  {
+    const char* env = std::getenv(name);
+    int n = env ? std::atoi(env) : n_default;
+    return (n > 0) ? n : n_default;
+  }
+
+  std::vector<std::thread> m_workers;
+
+  std::deque<std::function<void()>> m_queue;
+
+  std::mutex m_mutex;
+
+  std::condition_variable m_cv;
+
+  bool m_stop;
+};
+
+}; // namespace btas
+
+#endif // _BTAS_CXX11_THREADPOOL_H
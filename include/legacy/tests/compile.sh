@@ -0,0 +1,6 @@
+#!/bin/sh
+
+SRC=$1
+EXE=${SRC%.*}.x
+
+g++ -O3 -std=c++0x -fopenmp -D_HAS_CBLAS -D_HAS_INTEL_MKL -D_DEFAULT_QUANTUM -D_ENABLE_DEFAULT_QUANTUM -I../.. -I/opt/intel/mkl/include ${SRC} -o ${EXE} -L/opt/intel/mkl/lib/intel64 -lmkl_intel_lp64 -lmkl_sequential -lmkl_core -lpthread -lboost_serialization
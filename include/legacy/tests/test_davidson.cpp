@@ -0,0 +1,182 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <legacy/QSPARSE/QSDArray.h>
+#include <legacy/QSPARSE/QSTdavidson.h>
+
+using namespace btas;
+
+typedef QSDArray<2> Vector;
+
+/// elements of x in order of blocks of tmpl, missing blocks are zero
+std::vector<double> flatten (const Vector& x, const Vector& tmpl)
+{
+   std::vector<double> v;
+   for(auto it = tmpl.begin(); it != tmpl.end(); ++it) {
+      auto ix = x.find(it->first);
+      if(ix != x.end())
+         v.insert(v.end(), ix->second->begin(), ix->second->end());
+      else
+         v.insert(v.end(), it->second->size(), 0.0);
+   }
+   return v;
+}
+
+/// y has blocks of tmpl, with elements of v
+void unflatten (const std::vector<double>& v, const Vector& tmpl, Vector& y)
+{
+   Copy(tmpl, y);
+   auto iv = v.begin();
+   for(auto it = y.begin(); it != y.end(); ++it)
+      for(auto ix = it->second->begin(); ix != it->second->end(); ++ix) *ix = *iv++;
+}
+
+/// dense symmetric operator H = Z diag(w) Z^T on the flattened vector space
+struct Operator
+{
+   size_t n;
+   std::vector<double> h;
+   Vector tmpl;
+   int nCalls;
+
+   void operator() (const Vector& x, Vector& y)
+   {
+      std::vector<double> u = flatten(x, tmpl), v(n, 0.0);
+      for(size_t i = 0; i < n; ++i)
+         for(size_t j = 0; j < n; ++j) v[i] += h[i*n+j]*u[j];
+      unflatten(v, tmpl, y);
+      ++nCalls;
+   }
+
+   void block (const std::vector<Vector>& x, std::vector<Vector>& y)
+   {
+      y.resize(x.size());
+      for(size_t k = 0; k < x.size(); ++k) (*this)(x[k], y[k]);
+   }
+};
+
+int main ()
+{
+   std::mt19937 rgen(1);
+   std::normal_distribution<double> dist;
+
+   int nFail = 0;
+
+   std::cout.setf(std::ios::scientific, std::ios::floatfield);
+   std::cout.precision(2);
+
+   // 3 sectors with dimensions 12, 30, 12
+   Qshapes<Quantum> qs;
+   qs.push_back(Quantum(-1));
+   qs.push_back(Quantum( 0));
+   qs.push_back(Quantum(+1));
+   Dshapes dr = { 3, 5, 4 };
+   Dshapes dc = { 4, 6, 3 };
+   TVector<Qshapes<Quantum>, 2> q_shape = { qs, -qs };
+   TVector<Dshapes, 2> d_shape = { dr, dc };
+
+   Operator op;
+   op.tmpl.resize(Quantum::zero(), q_shape, d_shape);
+   op.n = flatten(op.tmpl, op.tmpl).size();
+   const size_t n = op.n;
+
+   // spectrum : -2, -1, -1 (degenerate pair), -0.5, then 1, 2, ... for the rest
+   std::vector<double> w(n);
+   w[0] = -2.0; w[1] = -1.0; w[2] = -1.0; w[3] = -0.5;
+   for(size_t k = 4; k < n; ++k) w[k] = k-3.0;
+
+   // orthogonal Z by Gram-Schmidt of I + 0.05 * random, stored by columns, s.t. H is diagonally dominant as in dmrg
+   std::vector<double> z(n*n);
+   for(size_t k = 0; k < n; ++k) {
+      double* zk = z.data()+k*n;
+      for(size_t i = 0; i < n; ++i) zk[i] = ((i == k) ? 1.0 : 0.0)+0.05*dist(rgen);
+      for(int pass = 0; pass < 2; ++pass)
+         for(size_t l = 0; l < k; ++l) {
+            const double* zl = z.data()+l*n;
+            double s = 0.0;
+            for(size_t i = 0; i < n; ++i) s += zl[i]*zk[i];
+            for(size_t i = 0; i < n; ++i) zk[i] -= s*zl[i];
+         }
+      double s = 0.0;
+      for(size_t i = 0; i < n; ++i) s += zk[i]*zk[i];
+      for(size_t i = 0; i < n; ++i) zk[i] /= std::sqrt(s);
+   }
+   op.h.assign(n*n, 0.0);
+   for(size_t k = 0; k < n; ++k)
+      for(size_t i = 0; i < n; ++i)
+         for(size_t j = 0; j < n; ++j) op.h[i*n+j] += z[k*n+i]*w[k]*z[k*n+j];
+
+   std::vector<double> hd(n);
+   for(size_t i = 0; i < n; ++i) hd[i] = op.h[i*n+i];
+   Vector diag;
+   unflatten(hd, op.tmpl, diag);
+
+   const double tol = 1.0e-6;
+
+   // nroots, max. subspace, number of initial guesses, expansion, block functor
+   struct Case { int nroots; int max_subspace; int nguess; BTAS_SUBSPACE_EXPANSION expansion; bool block; };
+   const Case cases[] = {
+      { 1,  4, 1, DavidsonExpansion, false },
+      { 4,  8, 1, DavidsonExpansion, false },
+      { 4,  8, 4, DavidsonExpansion, true  },
+      { 4, 10, 4, LanczosExpansion,  true  },
+   };
+
+   // solver is reused over cases, as it is in dmrg
+   QSTdavidson<double, 2, Quantum> solver;
+   solver.set_tol(tol);
+   solver.set_max_iter(200);
+
+   for(const Case& c : cases) {
+      solver.set_max_subspace(c.max_subspace);
+      solver.set_expansion(c.expansion);
+
+      std::vector<Vector> x(c.nguess);
+      for(int k = 0; k < c.nguess; ++k) {
+         std::vector<double> v(n);
+         for(size_t i = 0; i < n; ++i) v[i] = dist(rgen);
+         unflatten(v, op.tmpl, x[k]);
+      }
+
+      op.nCalls = 0;
+      QSTdavidson<double, 2, Quantum>::Functor f_sigma = [&op] (const Vector& a, Vector& b) { op(a, b); };
+      QSTdavidson<double, 2, Quantum>::BlockFunctor f_block;
+      if(c.block) f_block = [&op] (const std::vector<Vector>& a, std::vector<Vector>& b) { op.block(a, b); };
+      std::vector<double> evals = solver.solve(f_sigma, f_block, diag, x, c.nroots);
+
+      // eigenvalues, residuals |H x - e x| and orthonormality of eigenvectors
+      double eErr = 0.0;
+      double rErr = 0.0;
+      double oErr = 0.0;
+      for(int k = 0; k < c.nroots; ++k) {
+         eErr = std::max(eErr, std::fabs(evals[k]-w[k]));
+         Vector hx;
+         op(x[k], hx);
+         Axpy(-evals[k], x[k], hx);
+         rErr = std::max(rErr, std::sqrt(Dotc(hx, hx)));
+         for(int l = 0; l <= k; ++l)
+            oErr = std::max(oErr, std::fabs(Dotc(x[l], x[k])-((k == l) ? 1.0 : 0.0)));
+      }
+
+      // each iteration adds one vector at least, thus the subspace must have been collapsed
+      bool restarted = (c.nroots+solver.iterations() > c.max_subspace);
+
+      bool fail = (eErr > 1.0e-8 || rErr > 2*tol || oErr > 1.0e-10 || !restarted || solver.iterations() >= 200);
+      std::cout << "\t" << ((c.expansion == DavidsonExpansion) ? "Davidson" : "Lanczos ") << " roots = " << c.nroots
+                << " max. subspace = " << std::setw(2) << c.max_subspace << " guesses = " << c.nguess << (c.block ? " block" : " ")
+                << " : iter. = " << std::setw(3) << solver.iterations() << " sigma = " << std::setw(3) << op.nCalls
+                << " max|de| = " << eErr << " max|r| = " << rErr << " max|dS| = " << oErr << (fail ? " FAIL" : "") << std::endl;
+      if(fail) ++nFail;
+   }
+
+   if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+   else
+      std::cout << "FAIL: " << nFail << " cases" << std::endl;
+
+   return nFail;
+}
@@ -0,0 +1,250 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <legacy/QSPARSE/QSDArray.h>
+#include <legacy/QSPARSE/QSTfused.h>
+
+using namespace btas;
+
+typedef QSDArray<2> Vector;
+
+/// random vector having diagonal blocks in sectors of the list
+Vector random_vector (std::mt19937& rgen, const TVector<Qshapes<Quantum>, 2>& q_shape, const TVector<Dshapes, 2>& d_shape, const std::vector<int>& sectors)
+{
+   std::normal_distribution<double> dist;
+   Vector x(Quantum::zero(), q_shape, d_shape, false);
+   for(int i : sectors) {
+      DArray<2> block(d_shape[0][i], d_shape[1][i]);
+      block.generate([&] () { return dist(rgen); });
+      x.insert(IVector<2>{ i, i }, block);
+   }
+   return x;
+}
+
+/// tags of non-zero blocks
+std::vector<int> tags_of (const Vector& x)
+{
+   std::vector<int> tags;
+   for(auto it = x.begin(); it != x.end(); ++it) tags.push_back(it->first);
+   return tags;
+}
+
+/// |x - y|, and whether x and y have the same blocks
+double distance (const Vector& x, const Vector& y, bool& same_blocks)
+{
+   same_blocks = (tags_of(x) == tags_of(y));
+   Vector d;
+   Copy(x, d);
+   Axpy(-1.0, y, d);
+   return std::sqrt(Dotc(d, d));
+}
+
+/// unfused Davidson's preconditioner, r / (theta - diag), or r / theta for blocks which diag doesn't have
+void precondition (double theta, const Vector& diag, Vector& r)
+{
+   for(auto it = r.begin(); it != r.end(); ++it) {
+      auto id = diag.find(it->first);
+      if(id != diag.end()) {
+         auto ix = it->second->begin();
+         auto dx = id->second->begin();
+         for(; ix != it->second->end(); ++ix, ++dx) {
+            double denm = theta-*dx;
+            if(std::fabs(denm) < 1.0e-12) denm = 1.0e-12;
+            *ix /= denm;
+         }
+      }
+      else {
+         Scal(1.0/theta, *it->second);
+      }
+   }
+}
+
+/// unfused Gram-Schmidt twice, v is orthogonalized, y = v / |v|
+/// \return norm of the orthogonalized v relative to the original
+double orthonormalize (const std::vector<const Vector*>& basis, Vector& v, Vector& y)
+{
+   double vnorm = std::sqrt(Dotc(v, v));
+   for(int pass = 0; pass < 2; ++pass) {
+      std::vector<double> s(basis.size());
+      for(size_t i = 0; i < basis.size(); ++i) s[i] = Dotc(*basis[i], v);
+      for(size_t i = 0; i < basis.size(); ++i) Axpy(-s[i], *basis[i], v);
+   }
+   double onorm = std::sqrt(Dotc(v, v));
+   Copy(v, y);
+   Scal(1.0/onorm, y);
+   return onorm/vnorm;
+}
+
+int main ()
+{
+   std::mt19937 rgen(1);
+
+   int nFail = 0;
+   const double tol = 1.0e-12;
+
+   std::cout.setf(std::ios::scientific, std::ios::floatfield);
+   std::cout.precision(2);
+
+   // 6 sectors, block of sector i is on the diagonal (i, i)
+   Qshapes<Quantum> qs;
+   for(int i = 0; i < 6; ++i) qs.push_back(Quantum(i-3));
+   Dshapes dr = { 2, 3, 4, 5, 3, 2 };
+   Dshapes dc = { 3, 4, 2, 3, 5, 1 };
+   TVector<Qshapes<Quantum>, 2> q_shape = { qs, -qs };
+   TVector<Dshapes, 2> d_shape = { dr, dc };
+
+   // x[0] and x[1] share sector 2, x[2] has nothing in common with them, x[3] has every sector
+   std::vector<Vector> x;
+   x.push_back(random_vector(rgen, q_shape, d_shape, { 0, 1, 2 }));
+   x.push_back(random_vector(rgen, q_shape, d_shape, { 2, 3 }));
+   x.push_back(random_vector(rgen, q_shape, d_shape, { 4, 5 }));
+   x.push_back(random_vector(rgen, q_shape, d_shape, { 0, 1, 2, 3, 4, 5 }));
+   std::vector<double> c = { 0.5, -1.5, 2.0, 0.25 };
+
+   // subsets of x : only x[0] and x[1], then x[0] and x[2] with no common block, then all
+   const std::vector<std::vector<int>> subsets = { { 0, 1 }, { 0, 2 }, { 1, 0, 2 }, { 0, 1, 2, 3 } };
+
+   auto pointers = [&x] (const std::vector<int>& s) {
+      std::vector<const Vector*> p;
+      for(int i : s) p.push_back(&x[i]);
+      return p;
+   };
+
+   auto report = [&nFail, tol] (const char* name, const std::vector<int>& s, double err, bool ok) {
+      bool fail = !ok || err > tol;
+      std::cout << "\t" << std::setw(17) << std::left << name << std::right << " x = {";
+      for(size_t i = 0; i < s.size(); ++i) std::cout << (i ? "," : "") << s[i];
+      std::cout << "}" << std::setw(9-2*s.size()) << " " << " : err = " << err << (fail ? " FAIL" : "") << std::endl;
+      if(fail) ++nFail;
+   };
+
+   // 1) QSTjoin : union of tags, and null where x[i] doesn't have the block
+   for(const auto& s : subsets) {
+      std::vector<const Vector*> px = pointers(s);
+      QSTjoined<double> j;
+      QSTjoin(px, j);
+      std::vector<int> tags;
+      for(const Vector* p : px) { std::vector<int> t = tags_of(*p); tags.insert(tags.end(), t.begin(), t.end()); }
+      std::sort(tags.begin(), tags.end());
+      tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+      bool ok = (j.tags == tags && j.k == px.size());
+      for(size_t t = 0; ok && t < j.tags.size(); ++t)
+         for(size_t i = 0; ok && i < px.size(); ++i) {
+            auto it = px[i]->find(j.tags[t]);
+            ok = (it == px[i]->end()) ? (j(t, i) == 0) : (j(t, i) == it->second->data() && j.sizes[t] == it->second->size());
+         }
+      report("QSTjoin", s, 0.0, ok);
+   }
+
+   // 2) QSTcombine vs. Axpy, into an empty y and into y with other blocks which must be removed
+   for(const auto& s : subsets) {
+      std::vector<const Vector*> px = pointers(s);
+      std::vector<double> cs;
+      for(int i : s) cs.push_back(c[i]);
+      Vector ref;
+      for(size_t i = 0; i < px.size(); ++i) Axpy(cs[i], *px[i], ref);
+      Vector y;
+      QSTcombine(px, cs, y);
+      bool same;
+      double err = distance(y, ref, same);
+      Vector z = random_vector(rgen, q_shape, d_shape, { 5 });
+      QSTcombine(px, cs, z);
+      bool same_z;
+      err = std::max(err, distance(z, ref, same_z));
+      report("QSTcombine", s, err, same && same_z);
+   }
+
+   // 3) QSTdotc vs. Dotc, against y with a partly disjoint block set
+   for(const auto& s : subsets) {
+      std::vector<const Vector*> px = pointers(s);
+      for(int iy : { 1, 2 }) {
+         std::vector<double> d = QSTdotc(px, x[iy]);
+         double err = 0.0;
+         for(size_t i = 0; i < px.size(); ++i) err = std::max(err, std::fabs(d[i]-Dotc(*px[i], x[iy])));
+         report(iy == 1 ? "QSTdotc (y = x1)" : "QSTdotc (y = x2)", s, err, d.size() == px.size());
+      }
+   }
+
+   // 4) QSTresidual vs. Axpy, norm and preconditioning, where diag lacks sectors 4 and 5
+   Vector diag = random_vector(rgen, q_shape, d_shape, { 0, 1, 2, 3 });
+   const double theta = -0.75;
+   for(const auto& s : subsets) {
+      if(s.size() < 2) continue;
+      // sigma vectors are the subset, and trial vectors are the same subset rotated by one
+      std::vector<const Vector*> sigma = pointers(s);
+      std::vector<const Vector*> trial(sigma.size());
+      for(size_t i = 0; i < sigma.size(); ++i) trial[i] = sigma[(i+1)%sigma.size()];
+      std::vector<double> cs;
+      for(int i : s) cs.push_back(c[i]);
+
+      Vector ref;
+      for(size_t i = 0; i < sigma.size(); ++i) {
+         Axpy(cs[i], *sigma[i], ref);
+         Axpy(-theta*cs[i], *trial[i], ref);
+      }
+      double rnorm_ref = std::sqrt(Dotc(ref, ref));
+
+      Vector r;
+      double rnorm = QSTresidual(sigma, trial, cs, theta, static_cast<const Vector*>(0), r);
+      bool same;
+      double err = std::max(distance(r, ref, same), std::fabs(rnorm-rnorm_ref));
+      report("QSTresidual", s, err, same);
+
+      precondition(theta, diag, ref);
+      rnorm = QSTresidual(sigma, trial, cs, theta, &diag, r);
+      err = std::max(distance(r, ref, same), std::fabs(rnorm-rnorm_ref));
+      report("QSTresidual (pre)", s, err, same);
+   }
+
+   // 5) QSTorthonormalize vs. Gram-Schmidt by Axpy and Dotc, where basis is built from the subset
+   for(const auto& s : subsets) {
+      std::vector<Vector> basis(s.size());
+      std::vector<const Vector*> pb;
+      for(size_t i = 0; i < s.size(); ++i) {
+         Vector v;
+         Copy(x[s[i]], v);
+         orthonormalize(pb, v, basis[i]);
+         pb.push_back(&basis[i]);
+      }
+      // v has a block which no basis vector has, and misses some of theirs
+      for(int iv : { 1, 2, 3 }) {
+         Vector v0, v1, y0, y1;
+         Copy(x[iv], v0);
+         Copy(x[iv], v1);
+         double ref = orthonormalize(pb, v0, y0);
+         double nrm = QSTorthonormalize(pb, v1, y1);
+         bool same;
+         double err = std::max(distance(y1, y0, same), std::fabs(nrm-ref));
+         if(ref < 1.0e-8) err = std::fabs(nrm-ref); // v is in span of basis, y isn't touched
+         report(iv == 1 ? "QSTorthonorm (x1)" : (iv == 2 ? "QSTorthonorm (x2)" : "QSTorthonorm (x3)"), s, err, ref < 1.0e-8 || same);
+      }
+   }
+
+   // 6) v = 3 * x0 in span of basis is rejected, and y is not touched
+   {
+      std::vector<const Vector*> pb;
+      Vector b;
+      Copy(x[0], b);
+      Scal(1.0/std::sqrt(Dotc(b, b)), b);
+      pb.push_back(&b);
+      Vector v, y;
+      Copy(x[0], v);
+      Scal(3.0, v);
+      Copy(x[2], y);
+      double nrm = QSTorthonormalize(pb, v, y);
+      bool same;
+      double err = distance(y, x[2], same);
+      report("QSTorthonorm (3x0)", { 0 }, err, nrm < 1.0e-8 && same);
+   }
+
+   if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+   else
+      std::cout << "FAIL: " << nFail << " cases" << std::endl;
+
+   return nFail;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <legacy/QSPARSE/QSDArray.h>
+
+using namespace btas;
+
+/// dense m x n matrix U * diag(s) * V^T, with random orthonormal U and V
+void random_block (std::mt19937& rgen, int m, int n, const std::vector<double>& s, DArray<2>& a)
+{
+   std::normal_distribution<double> dist;
+   int k = s.size();
+   DArray<2> u(m, k), v(n, k), r;
+   u.generate([&] () { return dist(rgen); });
+   v.generate([&] () { return dist(rgen); });
+   Geqrf(u, r);
+   Geqrf(v, r);
+   for(int i = 0; i < m; ++i)
+      for(int j = 0; j < k; ++j) u(i, j) *= s[j];
+   a.clear();
+   Gemm(CblasNoTrans, CblasTrans, 1.0, u, v, 0.0, a);
+}
+
+/// singular values in descending order
+std::vector<double> sorted_values (const SDArray<1>& s)
+{
+   std::vector<double> v;
+   for(auto it = s.begin(); it != s.end(); ++it) v.insert(v.end(), it->second->begin(), it->second->end());
+   std::sort(v.rbegin(), v.rend());
+   return v;
+}
+
+int main ()
+{
+   std::mt19937 rgen(1);
+
+   int nFail = 0;
+
+   std::cout.setf(std::ios::scientific, std::ios::floatfield);
+   std::cout.precision(2);
+
+   const int DMAX  = 20;
+   const int NOVER = 10;
+
+   Qshapes<Quantum> qs;
+   qs.push_back(Quantum(-1));
+   qs.push_back(Quantum( 0));
+   qs.push_back(Quantum(+1));
+
+   // block (1, 1) is 240 x 120, which is well above 2 * (DMAX + NOVER) = 60, thus decomposed by random sampling,
+   // the other blocks are too small and fall back to thin SVD
+   Dshapes dr = { 20, 240, 20 };
+   Dshapes dc = { 15, 120, 15 };
+
+   TVector<Qshapes<Quantum>, 2> q_shape = { qs, -qs };
+   TVector<Dshapes, 2> d_shape = { dr, dc };
+
+   // singular values decay as 10^(-j/10), and those of small blocks are shifted s.t. kept values come from every block
+   QSDArray<2> a(Quantum::zero(), q_shape, d_shape, false);
+   for(int i = 0; i < 3; ++i) {
+      int k = std::min(dr[i], dc[i]);
+      std::vector<double> s(k);
+      for(int j = 0; j < k; ++j) s[j] = std::pow(10.0, -(j+3*(i != 1))/10.0);
+      DArray<2> block;
+      random_block(rgen, dr[i], dc[i], s, block);
+      a.insert(IVector<2>{ i, i }, block);
+   }
+
+   // 1) dense kernel takes the sampled path for the large block, and its tail is close to the exact one
+   {
+      const DArray<2>& block = *a.find(IVector<2>{ 1, 1 })->second;
+      DArray<1> s;
+      DArray<2> u, vt;
+      double tail = Gesvd_random(block, s, u, vt, DMAX, NOVER, 2);
+      double exact = 0.0;
+      for(int j = DMAX; j < 120; ++j) exact += std::pow(10.0, -2.0*j/10.0);
+      bool sampled = (s.size() == DMAX);
+      double rdiff = std::fabs(tail-exact)/exact;
+      bool fail = !sampled || rdiff > 1.0e-6;
+      std::cout << "\tdense 240 x 120, rank " << DMAX << " : sampled = " << (sampled ? "yes" : "no")
+                << " tail = " << tail << " exact = " << exact << " rel. diff = " << rdiff << (fail ? " FAIL" : "") << std::endl;
+      if(fail) ++nFail;
+   }
+
+   // 2) block-sparse randomized SVD against thin SVD, with the large sector sampled
+   {
+      SDArray<1> s0, s1;
+      QSDArray<2> u0, u1, v0, v1;
+      double w0 = Gesvd       <double, 2, 2, Quantum, LeftArrow>(a, s0, u0, v0, DMAX);
+      double w1 = Gesvd_random<double, 2, 2, Quantum, LeftArrow>(a, s1, u1, v1, DMAX, NOVER, 2);
+      std::vector<double> sv0 = sorted_values(s0);
+      std::vector<double> sv1 = sorted_values(s1);
+      double sdiff = 0.0;
+      for(size_t k = 0; k < std::max(sv0.size(), sv1.size()); ++k)
+         sdiff = std::max(sdiff, std::fabs((k < sv0.size() ? sv0[k] : 0.0) - (k < sv1.size() ? sv1[k] : 0.0)));
+      double wdiff = std::fabs(w1-w0)/w0;
+      bool fail = (sv0.size() != sv1.size() || wdiff > 1.0e-6 || sdiff > 1.0e-8);
+      std::cout << "\tblock-sparse, DMAX = " << DMAX << " : weight (full) = " << w0 << " weight (random) = " << w1
+                << " rel. diff = " << wdiff << " max|ds| = " << sdiff << (fail ? " FAIL" : "") << std::endl;
+      if(fail) ++nFail;
+
+      // kept vectors reproduce the truncated matrix
+      QSDArray<2> ar;
+      Dimm(u1, s1);
+      Gemm(NoTrans, NoTrans, 1.0, u1, v1, 1.0, ar);
+      Axpy(-1.0, a, ar);
+      double rnorm = Dotc(ar, ar);
+      double rrel = std::fabs(rnorm-w0)/w0;
+      fail = rrel > 1.0e-6;
+      std::cout << "\t|A - U S V^T|^2 = " << rnorm << " rel. diff from weight = " << rrel << (fail ? " FAIL" : "") << std::endl;
+      if(fail) ++nFail;
+   }
+
+   if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+   else
+      std::cout << "FAIL: " << nFail << " cases" << std::endl;
+
+   return nFail;
+}
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <legacy/common/ThreadPool.h>
+#include <legacy/common/TaskGraph.h>
+
+using namespace btas;
+
+/// start and end stamps of each task, taken from a global counter
+struct Trace
+{
+   std::atomic<int> clock;
+   std::vector<int> start;
+   std::vector<int> end;
+   std::vector<std::thread::id> thread;
+
+   explicit Trace (size_t n) : clock(0), start(n, -1), end(n, -1), thread(n) { }
+
+   std::function<void()> task (size_t t, int sleep_ms = 0)
+   {
+      return [this, t, sleep_ms] {
+         start[t] = clock++;
+         thread[t] = std::this_thread::get_id();
+         if(sleep_ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+         end[t] = clock++;
+      };
+   }
+};
+
+int main ()
+{
+   ThreadPool pool(3);
+
+   int nFail = 0;
+
+   // 1) diamond and chain : 0 -> { 1, 2, 3 } -> 4 -> 5, and 6 independent of all, tasks run on pool
+   {
+      Trace tr(7);
+      TaskGraph g;
+      TaskGraph::Task t0 = g.add(tr.task(0, 5));
+      TaskGraph::Task t1 = g.add(tr.task(1, 5), { t0 });
+      TaskGraph::Task t2 = g.add(tr.task(2, 1), { t0 });
+      TaskGraph::Task t3 = g.add(tr.task(3, 3), { t0 });
+      TaskGraph::Task t4 = g.add(tr.task(4),    { t1, t2, t3 });
+                           g.add(tr.task(5),    { t4 });
+                           g.add(tr.task(6, 5));
+      bool ok = true;
+      for(int r = 0; r < 2 && ok; ++r) { // graph can be run again
+         std::fill(tr.start.begin(), tr.start.end(), -1);
+         g.run(&pool);
+         for(int t = 0; t < 7; ++t) ok &= (tr.end[t] >= 0);
+         for(int t : { 1, 2, 3 }) ok &= (tr.start[t] > tr.end[0] && tr.start[4] > tr.end[t]);
+         ok &= (tr.start[5] > tr.end[4]);
+      }
+      std::cout << "\tdependency order : " << (ok ? "OK" : "FAIL") << std::endl;
+      if(!ok) ++nFail;
+   }
+
+   // 2) on_caller tasks run on the calling thread in order of addition, even if a later one (2) gets ready first
+   {
+      Trace tr(5);
+      TaskGraph g;
+      TaskGraph::Task t0 = g.add(tr.task(0, 20));
+      TaskGraph::Task t1 = g.add(tr.task(1), { t0 }, true);
+      TaskGraph::Task t2 = g.add(tr.task(2), { }, true);
+      TaskGraph::Task t3 = g.add(tr.task(3), { t1, t2 }, true);
+                           g.add(tr.task(4), { t3 });
+      g.run(&pool);
+      std::thread::id caller = std::this_thread::get_id();
+      bool ok = (tr.thread[1] == caller && tr.thread[2] == caller && tr.thread[3] == caller);
+      ok &= (tr.thread[0] != caller && tr.thread[4] != caller);
+      ok &= (tr.start[1] > tr.end[0] && tr.start[2] > tr.end[1] && tr.start[3] > tr.end[2] && tr.start[4] > tr.end[3]);
+      std::cout << "\ton_caller thread and order : " << (ok ? "OK" : "FAIL") << std::endl;
+      if(!ok) ++nFail;
+   }
+
+   // 3) exception of a pool task, and of an on_caller task : re-thrown by run, and no dependent task is started
+   for(bool on_caller : { false, true }) {
+      Trace tr(4);
+      TaskGraph g;
+      TaskGraph::Task t0 = g.add([] { throw std::runtime_error("task 0"); }, { }, on_caller);
+      TaskGraph::Task t1 = g.add(tr.task(1, 10));
+                           g.add(tr.task(2), { t0 });
+                           g.add(tr.task(3), { t1 }, true);
+      bool thrown = false;
+      try { g.run(&pool); } catch(const std::runtime_error& e) { thrown = (std::string(e.what()) == "task 0"); }
+      // task 1 has been started before the error, and must be done before run returns
+      bool ok = thrown && tr.start[2] < 0 && (tr.start[1] < 0 || tr.end[1] >= 0);
+      std::cout << "\texception of " << (on_caller ? "on_caller" : "pool     ") << " task : " << (ok ? "OK" : "FAIL") << std::endl;
+      if(!ok) ++nFail;
+   }
+
+   // 4) w/o pool, tasks run on the calling thread in order of addition
+   {
+      Trace tr(3);
+      TaskGraph g;
+      TaskGraph::Task t0 = g.add(tr.task(0));
+      g.add(tr.task(1));
+      g.add(tr.task(2), { t0 });
+      g.run(0);
+      std::thread::id caller = std::this_thread::get_id();
+      bool ok = (tr.end[0] < tr.start[1] && tr.end[1] < tr.start[2]);
+      for(int t = 0; t < 3; ++t) ok &= (tr.thread[t] == caller);
+      std::cout << "\tserial run : " << (ok ? "OK" : "FAIL") << std::endl;
+      if(!ok) ++nFail;
+   }
+
+#ifdef _OPENMP
+   // 5) nested OpenMP threads of workers are capped
+   {
+      ThreadPool p2(2, 3);
+      bool ok = (p2.submit([] { return omp_get_max_threads(); }).get() == 3);
+      int nDefault = std::max(1, omp_get_max_threads() / 3);
+      ok &= (pool.submit([] { return omp_get_max_threads(); }).get() == nDefault);
+      std::cout << "\tOpenMP threads of workers : " << (ok ? "OK" : "FAIL") << std::endl;
+      if(!ok) ++nFail;
+   }
+#endif
+
+   if(nFail == 0)
+      std::cout << "PASS" << std::endl;
+   else
+      std::cout << "FAIL: " << nFail << " cases" << std::endl;
+
+   return nFail;
+}